@@ -0,0 +1,75 @@
+#include "AnimationPool.h"
+
+AnimationPool::AnimationPool(size_t capacity)
+{
+	this->capacity = capacity;
+	this->instances.reserve(capacity);
+}
+
+// Registers a clip and returns its id. Meant for startup only.
+int AnimationPool::addClip(int firstRegion, int frameCount, float speed)
+{
+	AnimationClip clip = { firstRegion, frameCount, speed };
+	this->clips.push_back(clip);
+	return (int)this->clips.size() - 1;
+}
+
+// Starts a clip at (x, y). Returns false if the pool is full.
+bool AnimationPool::play(int clip, float x, float y)
+{
+	if (this->instances.size() >= this->capacity)
+	{
+		return false;
+	}
+
+	AnimationInstance instance = { clip, 0.f, x, y };
+	this->instances.push_back(instance);
+	return true;
+}
+
+// Advances every instance by one tick and removes the ones that ran past
+// their last frame. Order is not kept.
+void AnimationPool::update()
+{
+	size_t i = 0;
+	while (i < this->instances.size())
+	{
+		AnimationInstance &instance = this->instances[i];
+		const AnimationClip &clip = this->clips[instance.clip];
+
+		instance.frame += clip.speed;
+		if (instance.frame >= clip.frameCount)
+		{
+			instance = this->instances.back();
+			this->instances.pop_back();
+			continue;
+		}
+		i++;
+	}
+}
+
+void AnimationPool::clear()
+{
+	this->instances.clear();
+}
+
+size_t AnimationPool::size() const
+{
+	return this->instances.size();
+}
+
+const AnimationInstance &AnimationPool::get(size_t index) const
+{
+	return this->instances[index];
+}
+
+// Atlas region of the frame instance index is showing.
+int AnimationPool::getRegion(size_t index) const
+{
+	const AnimationInstance &instance = this->instances[index];
+	return this->clips[instance.clip].firstRegion + (int)instance.frame;
+}
+
+AnimationPool::~AnimationPool()
+{
+}
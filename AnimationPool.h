@@ -0,0 +1,41 @@
+#pragma once
+#include <cstddef>
+#include <vector>
+
+// An animation as a run of consecutive atlas regions, advanced by speed frames
+// per tick. Clips are set up once and shared by every instance playing them.
+struct AnimationClip
+{
+	int firstRegion;
+	int frameCount;
+	float speed;
+};
+
+struct AnimationInstance
+{
+	int clip;
+	float frame;
+	float x, y;
+};
+
+// Fixed-capacity set of running animations. All storage is reserved up front,
+// finished instances are swap-removed, and play() drops the request when the
+// pool is full, so playing and updating never allocate.
+class AnimationPool
+{
+private:
+	std::vector<AnimationClip> clips;
+	std::vector<AnimationInstance> instances;
+	size_t capacity;
+
+public:
+	AnimationPool(size_t);
+	int addClip(int, int, float);
+	bool play(int, float, float);
+	void update();
+	void clear();
+	size_t size() const;
+	const AnimationInstance &get(size_t) const;
+	int getRegion(size_t) const;
+	~AnimationPool();
+};
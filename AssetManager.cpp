@@ -0,0 +1,228 @@
+#include "AssetManager.h"
+
+#include <algorithm>
+
+#include "BakedAsset.h"
+
+AssetManager::AssetManager()
+	: nextAsset(0), finishedCount(0)
+{
+	this->taken = 0;
+	this->threadCount = 0;
+	this->pack = nullptr;
+	this->totalMilliseconds = 0;
+}
+
+int AssetManager::add(const std::string &path, int type)
+{
+	std::unique_ptr<Asset> asset(new Asset());
+	asset->path = path;
+	asset->type = type;
+	asset->loaded = false;
+	asset->source = "";
+	asset->milliseconds = 0;
+	this->assets.push_back(std::move(asset));
+	return (int)this->assets.size() - 1;
+}
+
+// Queues an image file and returns its id. Only before start().
+int AssetManager::addImage(const std::string &path)
+{
+	return this->add(path, AssetImage);
+}
+
+int AssetManager::addSound(const std::string &path)
+{
+	return this->add(path, AssetSound);
+}
+
+// Pack to decode from, or null for loose files only. Only before start(); the
+// pack has to stay open while assets are loading.
+void AssetManager::setPack(const AssetPack *pack)
+{
+	this->pack = pack;
+}
+
+// Starts decoding on threadCount threads, 0 for one per hardware thread.
+// Never more threads than files.
+void AssetManager::start(int threadCount)
+{
+	if (threadCount <= 0)
+	{
+		threadCount = (int)std::thread::hardware_concurrency();
+	}
+	threadCount = std::max(1, std::min(threadCount, this->getCount()));
+
+	this->threadCount = threadCount;
+	this->startTime = std::chrono::steady_clock::now();
+	for (int t = 0; t < threadCount; t++)
+	{
+		this->threads.push_back(std::thread(&AssetManager::worker, this));
+	}
+}
+
+// Takes files off the queue until it is empty. Every asset is written by one
+// worker only and handed over through the finished list.
+void AssetManager::worker()
+{
+	for (;;)
+	{
+		int index = this->nextAsset++;
+		if (index >= this->getCount())
+		{
+			return;
+		}
+
+		Asset &asset = *this->assets[index];
+		std::chrono::steady_clock::time_point begin = std::chrono::steady_clock::now();
+		asset.loaded = this->loadBaked(asset) || this->loadOriginal(asset);
+		asset.milliseconds = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - begin).count();
+
+		std::lock_guard<std::mutex> guard(this->lock);
+		this->finished.push_back(index);
+		this->finishedCount++;
+	}
+}
+
+// Copies the baked pixels or samples in, if there is a baked file for asset
+// that matches its type. Premultiplied images are skipped, since the game
+// draws with straight alpha.
+bool AssetManager::loadBaked(Asset &asset)
+{
+	std::string path = baked_path(asset.path);
+	const void *data;
+	size_t size;
+	std::vector<unsigned char> bytes;
+	if (this->pack && this->pack->lookup(path, data, size))
+	{
+		asset.source = "baked, pack";
+	}
+	else if (read_asset_file(path, bytes))
+	{
+		data = bytes.data();
+		size = bytes.size();
+		asset.source = "baked, file";
+	}
+	else
+	{
+		return false;
+	}
+
+	if (asset.type == AssetImage)
+	{
+		BakedImage baked;
+		if (!read_baked_image(data, size, baked) || baked.flags & BAKED_PREMULTIPLIED)
+		{
+			return false;
+		}
+		asset.image.create(baked.width, baked.height, baked.pixels);
+		return true;
+	}
+
+	BakedSound baked;
+	return read_baked_sound(data, size, baked) &&
+		asset.sound.loadFromSamples(baked.samples, baked.sampleCount, baked.channels, baked.sampleRate);
+}
+
+// Decodes the original file.
+bool AssetManager::loadOriginal(Asset &asset)
+{
+	const void *data;
+	size_t size;
+	bool fromPack = this->pack && this->pack->lookup(asset.path, data, size);
+	asset.source = fromPack ? "pack" : "file";
+	if (asset.type == AssetImage)
+	{
+		return fromPack ? asset.image.loadFromMemory(data, size) : asset.image.loadFromFile(asset.path);
+	}
+	return fromPack ? asset.sound.loadFromMemory(data, size) : asset.sound.loadFromFile(asset.path);
+}
+
+// Hands out the next finished asset, if any. Main thread only.
+bool AssetManager::takeFinished(int &index)
+{
+	std::lock_guard<std::mutex> guard(this->lock);
+	if (this->taken == this->finished.size())
+	{
+		return false;
+	}
+	index = this->finished[this->taken++];
+	return true;
+}
+
+int AssetManager::getCount() const
+{
+	return (int)this->assets.size();
+}
+
+int AssetManager::getFinishedCount() const
+{
+	return this->finishedCount;
+}
+
+// Blocks until every file is decoded and the workers have exited.
+void AssetManager::wait()
+{
+	if (this->threads.empty())
+	{
+		return;
+	}
+
+	for (size_t t = 0; t < this->threads.size(); t++)
+	{
+		this->threads[t].join();
+	}
+	this->threads.clear();
+	this->totalMilliseconds = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - this->startTime).count();
+}
+
+int AssetManager::getType(int index) const
+{
+	return this->assets[index]->type;
+}
+
+const std::string &AssetManager::getPath(int index) const
+{
+	return this->assets[index]->path;
+}
+
+bool AssetManager::isLoaded(int index) const
+{
+	return this->assets[index]->loaded;
+}
+
+const Image &AssetManager::getImage(int index) const
+{
+	return this->assets[index]->image;
+}
+
+const SoundBuffer &AssetManager::getSound(int index) const
+{
+	return this->assets[index]->sound;
+}
+
+// Frees the decoded pixels once they have been uploaded.
+void AssetManager::releaseImage(int index)
+{
+	this->assets[index]->image = Image();
+}
+
+// One line per file with its decode time, then the wall time of the whole
+// load, which the parallel decode keeps close to the slowest line.
+void AssetManager::report(FILE *out) const
+{
+	double sum = 0;
+	for (size_t i = 0; i < this->assets.size(); i++)
+	{
+		const Asset &asset = *this->assets[i];
+		std::fprintf(out, "%-20s %8.2f ms  %s%s\n", asset.path.c_str(), asset.milliseconds, asset.source,
+			asset.loaded ? "" : "  FAILED");
+		sum += asset.milliseconds;
+	}
+	std::fprintf(out, "%-20s %8.2f ms (%.2f ms decoding, %d threads)\n", "total", this->totalMilliseconds, sum, this->threadCount);
+}
+
+AssetManager::~AssetManager()
+{
+	this->wait();
+}
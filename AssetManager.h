@@ -0,0 +1,85 @@
+#pragma once
+#include <SFML/Graphics.hpp>
+#include <SFML/Audio.hpp>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "AssetPack.h"
+
+using namespace sf;
+
+enum AssetType
+{
+	AssetImage,
+	AssetSound
+};
+
+// Decodes image and sound files on worker threads so startup takes about as
+// long as the slowest file instead of the sum of all of them. Queue every
+// file with addImage()/addSound(), call start(), then poll takeFinished()
+// from the main thread and do the GL side (texture uploads, atlas packing)
+// there as each one arrives. Finished assets stay owned by the manager, so
+// sounds can keep playing from its buffers.
+//
+// Each asset comes from the first of these that works: its baked copy
+// (BakedAsset.h) in the pack given to setPack(), the baked copy on disk, the
+// original in the pack, the original on disk. Baked copies skip decoding;
+// pack entries are read straight from the mapping.
+class AssetManager
+{
+private:
+	struct Asset
+	{
+		std::string path;
+		int type;
+		Image image;
+		SoundBuffer sound;
+		bool loaded;
+		// where it was loaded from, for report()
+		const char *source;
+		double milliseconds;
+	};
+
+	std::vector<std::unique_ptr<Asset>> assets;
+	std::vector<std::thread> threads;
+	std::atomic<int> nextAsset;
+	std::atomic<int> finishedCount;
+	std::mutex lock;
+	// in finishing order; the ones from taken on are not handed out yet
+	std::vector<int> finished;
+	size_t taken;
+	int threadCount;
+	const AssetPack *pack;
+	std::chrono::steady_clock::time_point startTime;
+	double totalMilliseconds;
+
+	int add(const std::string &, int);
+	bool loadBaked(Asset &);
+	bool loadOriginal(Asset &);
+	void worker();
+
+public:
+	AssetManager();
+	int addImage(const std::string &);
+	int addSound(const std::string &);
+	void setPack(const AssetPack *);
+	void start(int);
+	bool takeFinished(int &);
+	int getCount() const;
+	int getFinishedCount() const;
+	void wait();
+	int getType(int) const;
+	const std::string &getPath(int) const;
+	bool isLoaded(int) const;
+	const Image &getImage(int) const;
+	const SoundBuffer &getSound(int) const;
+	void releaseImage(int);
+	void report(FILE *) const;
+	~AssetManager();
+};
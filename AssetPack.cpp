@@ -0,0 +1,351 @@
+#include "AssetPack.h"
+
+#include <cstdio>
+#include <cstring>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+static const char MAGIC[4] = { 'A', 'S', 'P', 'K' };
+static const unsigned VERSION = 1;
+static const size_t HEADER_SIZE = 12;
+static const size_t ENTRY_SIZE = ASSET_PACK_NAME + 1 + 3 * 8;
+static const size_t DATA_ALIGN = 16;
+
+static unsigned get_u32(const unsigned char *bytes)
+{
+	return bytes[0] | bytes[1] << 8 | bytes[2] << 16 | (unsigned)bytes[3] << 24;
+}
+
+static unsigned long long get_u64(const unsigned char *bytes)
+{
+	return get_u32(bytes) | (unsigned long long)get_u32(bytes + 4) << 32;
+}
+
+static void put_u32(FILE *file, unsigned value)
+{
+	unsigned char bytes[4] = { (unsigned char)value, (unsigned char)(value >> 8), (unsigned char)(value >> 16), (unsigned char)(value >> 24) };
+	std::fwrite(bytes, 1, 4, file);
+}
+
+static void put_u64(FILE *file, unsigned long long value)
+{
+	put_u32(file, (unsigned)value);
+	put_u32(file, (unsigned)(value >> 32));
+}
+
+// FNV-1a, 64-bit
+unsigned long long asset_checksum(const void *data, size_t size)
+{
+	const unsigned char *bytes = (const unsigned char *)data;
+	unsigned long long hash = 14695981039346656037ull;
+	for (size_t i = 0; i < size; i++)
+	{
+		hash ^= bytes[i];
+		hash *= 1099511628211ull;
+	}
+	return hash;
+}
+
+AssetPack::AssetPack()
+{
+	this->data = nullptr;
+	this->size = 0;
+	this->checking = false;
+}
+
+// Maps the pack at path and reads its table of contents. Returns false if it
+// is missing or not a pack; the game then loads the loose files.
+bool AssetPack::open(const char *path)
+{
+	this->close();
+
+#ifdef _WIN32
+	HANDLE file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+	if (file == INVALID_HANDLE_VALUE)
+	{
+		return false;
+	}
+	LARGE_INTEGER fileSize;
+	HANDLE mapping = nullptr;
+	if (GetFileSizeEx(file, &fileSize) && fileSize.QuadPart > 0)
+	{
+		mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	}
+	CloseHandle(file);
+	if (!mapping)
+	{
+		return false;
+	}
+	// the view keeps the mapping alive on its own
+	this->data = (const unsigned char *)MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+	CloseHandle(mapping);
+	if (!this->data)
+	{
+		return false;
+	}
+	this->size = (size_t)fileSize.QuadPart;
+#else
+	int fd = ::open(path, O_RDONLY);
+	if (fd < 0)
+	{
+		return false;
+	}
+	struct stat info;
+	void *mapped = MAP_FAILED;
+	if (fstat(fd, &info) == 0 && info.st_size > 0)
+	{
+		mapped = mmap(nullptr, (size_t)info.st_size, PROT_READ, MAP_SHARED, fd, 0);
+	}
+	// the mapping keeps the file open on its own
+	::close(fd);
+	if (mapped == MAP_FAILED)
+	{
+		return false;
+	}
+	this->data = (const unsigned char *)mapped;
+	this->size = (size_t)info.st_size;
+#endif
+
+	if (!this->readContents())
+	{
+		this->close();
+		return false;
+	}
+	return true;
+}
+
+// Parses the table of contents, rejecting any entry that points past the end
+// of the file.
+bool AssetPack::readContents()
+{
+	if (this->size < HEADER_SIZE || std::memcmp(this->data, MAGIC, 4) != 0 || get_u32(this->data + 4) != VERSION)
+	{
+		return false;
+	}
+
+	size_t count = get_u32(this->data + 8);
+	if (count > (this->size - HEADER_SIZE) / ENTRY_SIZE)
+	{
+		return false;
+	}
+
+	this->entries.resize(count);
+	for (size_t i = 0; i < count; i++)
+	{
+		const unsigned char *bytes = this->data + HEADER_SIZE + i * ENTRY_SIZE;
+		const unsigned char *numbers = bytes + ASSET_PACK_NAME + 1;
+		unsigned long long offset = get_u64(numbers);
+		unsigned long long size = get_u64(numbers + 8);
+		if (offset > this->size || size > this->size - offset)
+		{
+			return false;
+		}
+
+		AssetPackEntry &entry = this->entries[i];
+		const void *end = std::memchr(bytes, 0, ASSET_PACK_NAME);
+		entry.name.assign((const char *)bytes, end ? (const unsigned char *)end - bytes : ASSET_PACK_NAME);
+		entry.offset = (size_t)offset;
+		entry.size = (size_t)size;
+		entry.checksum = get_u64(numbers + 16);
+	}
+	return true;
+}
+
+bool AssetPack::isOpen() const
+{
+	return this->data != nullptr;
+}
+
+// Unmaps the pack; every pointer it handed out becomes invalid.
+void AssetPack::close()
+{
+	if (this->data)
+	{
+#ifdef _WIN32
+		UnmapViewOfFile(this->data);
+#else
+		munmap((void *)this->data, this->size);
+#endif
+	}
+	this->data = nullptr;
+	this->size = 0;
+	this->entries.clear();
+}
+
+// Index of the entry called name, or -1. A pack holds a dozen files, so a
+// linear scan is all it needs.
+int AssetPack::find(const std::string &name) const
+{
+	for (size_t i = 0; i < this->entries.size(); i++)
+	{
+		if (this->entries[i].name == name)
+		{
+			return (int)i;
+		}
+	}
+	return -1;
+}
+
+int AssetPack::getCount() const
+{
+	return (int)this->entries.size();
+}
+
+const AssetPackEntry &AssetPack::getEntry(int index) const
+{
+	return this->entries[index];
+}
+
+const void *AssetPack::getData(int index) const
+{
+	return this->data + this->entries[index].offset;
+}
+
+// Hashes the entry's bytes against the table of contents. This reads every
+// page of the entry.
+bool AssetPack::verify(int index) const
+{
+	const AssetPackEntry &entry = this->entries[index];
+	return asset_checksum(this->getData(index), entry.size) == entry.checksum;
+}
+
+// Whether lookup() verifies each entry it hands out. Off by default, since
+// hashing reads the whole entry up front.
+void AssetPack::setChecking(bool checking)
+{
+	this->checking = checking;
+}
+
+// Finds name and, when checking, verifies it. Returns false, leaving data and
+// size alone, when the pack is not open, has no such entry, or the entry is
+// damaged.
+bool AssetPack::lookup(const std::string &name, const void *&data, size_t &size) const
+{
+	int index = this->find(name);
+	if (index < 0)
+	{
+		return false;
+	}
+	if (this->checking && !this->verify(index))
+	{
+		std::fprintf(stderr, "asset pack: checksum mismatch in %s\n", name.c_str());
+		return false;
+	}
+
+	data = this->getData(index);
+	size = this->entries[index].size;
+	return true;
+}
+
+AssetPack::~AssetPack()
+{
+	this->close();
+}
+
+// Reads a whole file into bytes.
+bool read_asset_file(const std::string &path, std::vector<unsigned char> &bytes)
+{
+	FILE *file = std::fopen(path.c_str(), "rb");
+	if (!file)
+	{
+		return false;
+	}
+
+	bytes.clear();
+	unsigned char chunk[65536];
+	size_t got;
+	while ((got = std::fread(chunk, 1, sizeof(chunk), file)) > 0)
+	{
+		bytes.insert(bytes.end(), chunk, chunk + got);
+	}
+	bool ok = !std::ferror(file);
+	std::fclose(file);
+	return ok;
+}
+
+// Writes a pack at path holding the given files, each stored under its name
+// without the directory, which is what the game looks it up by.
+bool write_asset_pack(const char *path, const std::vector<std::string> &files)
+{
+	std::vector<std::vector<unsigned char>> contents(files.size());
+	std::vector<std::string> names(files.size());
+	for (size_t i = 0; i < files.size(); i++)
+	{
+		size_t slash = files[i].find_last_of("/\\");
+		names[i] = slash == std::string::npos ? files[i] : files[i].substr(slash + 1);
+		if (names[i].empty() || names[i].size() > ASSET_PACK_NAME)
+		{
+			std::fprintf(stderr, "%s: name must be 1 to %u characters\n", files[i].c_str(), (unsigned)ASSET_PACK_NAME);
+			return false;
+		}
+		// find() stops at the first match, so a second entry of the same name
+		// could never be looked up
+		for (size_t k = 0; k < i; k++)
+		{
+			if (names[k] == names[i])
+			{
+				std::fprintf(stderr, "%s and %s would both be stored as %s\n", files[k].c_str(), files[i].c_str(), names[i].c_str());
+				return false;
+			}
+		}
+		if (!read_asset_file(files[i], contents[i]))
+		{
+			std::fprintf(stderr, "cannot read %s\n", files[i].c_str());
+			return false;
+		}
+	}
+
+	FILE *out = std::fopen(path, "wb");
+	if (!out)
+	{
+		std::fprintf(stderr, "cannot create %s\n", path);
+		return false;
+	}
+
+	std::fwrite(MAGIC, 1, 4, out);
+	put_u32(out, VERSION);
+	put_u32(out, (unsigned)files.size());
+
+	size_t offset = HEADER_SIZE + files.size() * ENTRY_SIZE;
+	std::vector<size_t> offsets(files.size());
+	for (size_t i = 0; i < files.size(); i++)
+	{
+		offset = (offset + DATA_ALIGN - 1) / DATA_ALIGN * DATA_ALIGN;
+		offsets[i] = offset;
+		offset += contents[i].size();
+
+		char name[ASSET_PACK_NAME + 1] = {};
+		std::memcpy(name, names[i].data(), names[i].size());
+		std::fwrite(name, 1, sizeof(name), out);
+		put_u64(out, offsets[i]);
+		put_u64(out, contents[i].size());
+		put_u64(out, asset_checksum(contents[i].data(), contents[i].size()));
+	}
+
+	static const unsigned char padding[DATA_ALIGN] = {};
+	size_t written = HEADER_SIZE + files.size() * ENTRY_SIZE;
+	for (size_t i = 0; i < files.size(); i++)
+	{
+		std::fwrite(padding, 1, offsets[i] - written, out);
+		std::fwrite(contents[i].data(), 1, contents[i].size(), out);
+		written = offsets[i] + contents[i].size();
+	}
+
+	bool ok = !std::ferror(out);
+	ok = std::fclose(out) == 0 && ok;
+	if (!ok)
+	{
+		std::fprintf(stderr, "cannot write %s\n", path);
+	}
+	return ok;
+}
@@ -0,0 +1,57 @@
+#pragma once
+#include <cstddef>
+#include <string>
+#include <vector>
+
+// longest name a pack entry can have, not counting the terminating zero
+static const size_t ASSET_PACK_NAME = 47;
+
+struct AssetPackEntry
+{
+	std::string name;
+	size_t offset;
+	size_t size;
+	unsigned long long checksum;
+};
+
+// Read-only view of an asset pack: every asset in one file behind a table of
+// contents. open() maps the whole file, so lookup() hands out pointers into
+// the mapping that go straight to loadFromMemory()/openFromMemory(), with no
+// read and no copy, and the pages are shared by every game running on the
+// machine. The pointers stay valid until close().
+//
+// Pages are only read when an asset is, so lookup() does not check the
+// checksums unless setChecking() asked for it; asteroid_pack checks every
+// entry when it writes the pack.
+//
+// Layout, little-endian: "ASPK", u32 version, u32 entry count, then per entry
+// a 48-byte zero-padded name, u64 offset, u64 size and u64 FNV-1a checksum.
+// The data follows, each file starting on a 16-byte boundary.
+class AssetPack
+{
+private:
+	const unsigned char *data;
+	size_t size;
+	std::vector<AssetPackEntry> entries;
+	bool checking;
+
+	bool readContents();
+
+public:
+	AssetPack();
+	bool open(const char *);
+	bool isOpen() const;
+	void close();
+	void setChecking(bool);
+	int find(const std::string &) const;
+	int getCount() const;
+	const AssetPackEntry &getEntry(int) const;
+	const void *getData(int) const;
+	bool verify(int) const;
+	bool lookup(const std::string &, const void *&, size_t &) const;
+	~AssetPack();
+};
+
+unsigned long long asset_checksum(const void *, size_t);
+bool read_asset_file(const std::string &, std::vector<unsigned char> &);
+bool write_asset_pack(const char *, const std::vector<std::string> &);
@@ -0,0 +1,70 @@
+// Decodes images and sounds once, at build time, and writes each as a baked
+// file (BakedAsset.h) in OUTDIR, named after the original with ".raw"
+// appended. The game loads those instead of the originals when it finds them.
+// --premultiply bakes images with alpha multiplied in; the game itself draws
+// with straight alpha and skips such files.
+//
+// usage: asteroid_bake [--premultiply] OUTDIR FILE...
+
+#include <SFML/Audio.hpp>
+#include <SFML/Graphics.hpp>
+#include <cstdio>
+#include <cstring>
+#include <string>
+
+#include "BakedAsset.h"
+
+using namespace sf;
+
+static bool is_sound(const std::string &path)
+{
+	size_t dot = path.find_last_of('.');
+	std::string extension = dot == std::string::npos ? "" : path.substr(dot + 1);
+	return extension == "wav" || extension == "ogg" || extension == "flac";
+}
+
+int main(int argc, char **argv)
+{
+	int arg = 1;
+	bool premultiply = false;
+	if (arg < argc && std::strcmp(argv[arg], "--premultiply") == 0)
+	{
+		premultiply = true;
+		arg++;
+	}
+	if (argc - arg < 2)
+	{
+		std::fprintf(stderr, "usage: %s [--premultiply] OUTDIR FILE...\n", argv[0]);
+		return 2;
+	}
+
+	std::string outDir = argv[arg++];
+	for (; arg < argc; arg++)
+	{
+		std::string path = argv[arg];
+		size_t slash = path.find_last_of("/\\");
+		std::string out = baked_path(outDir + "/" + (slash == std::string::npos ? path : path.substr(slash + 1)));
+
+		bool ok;
+		if (is_sound(path))
+		{
+			SoundBuffer sound;
+			ok = sound.loadFromFile(path) &&
+				write_baked_sound(out.c_str(), sound.getSamples(), (unsigned)sound.getSampleCount(), sound.getChannelCount(), sound.getSampleRate());
+		}
+		else
+		{
+			Image image;
+			ok = image.loadFromFile(path) &&
+				write_baked_image(out.c_str(), image.getSize().x, image.getSize().y, image.getPixelsPtr(), premultiply);
+		}
+
+		if (!ok)
+		{
+			std::fprintf(stderr, "cannot bake %s into %s\n", path.c_str(), out.c_str());
+			return 1;
+		}
+		std::printf("%s\n", out.c_str());
+	}
+	return 0;
+}
@@ -0,0 +1,127 @@
+#include "BakedAsset.h"
+
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+static const char IMAGE_MAGIC[4] = { 'A', 'S', 'R', 'I' };
+static const char SOUND_MAGIC[4] = { 'A', 'S', 'R', 'P' };
+static const unsigned VERSION = 1;
+static const size_t HEADER_SIZE = 16;
+
+static unsigned get_u16(const unsigned char *bytes)
+{
+	return bytes[0] | bytes[1] << 8;
+}
+
+static unsigned get_u32(const unsigned char *bytes)
+{
+	return bytes[0] | bytes[1] << 8 | bytes[2] << 16 | (unsigned)bytes[3] << 24;
+}
+
+static void put_u16(unsigned char *bytes, unsigned value)
+{
+	bytes[0] = (unsigned char)value;
+	bytes[1] = (unsigned char)(value >> 8);
+}
+
+static void put_u32(unsigned char *bytes, unsigned value)
+{
+	put_u16(bytes, value);
+	put_u16(bytes + 2, value >> 16);
+}
+
+// Where the baked copy of an asset file lives.
+std::string baked_path(const std::string &path)
+{
+	return path + ".raw";
+}
+
+// Checks the header and that all the pixels are there.
+bool read_baked_image(const void *data, size_t size, BakedImage &image)
+{
+	const unsigned char *bytes = (const unsigned char *)data;
+	if (size < HEADER_SIZE || std::memcmp(bytes, IMAGE_MAGIC, 4) != 0 || get_u16(bytes + 4) != VERSION)
+	{
+		return false;
+	}
+
+	image.flags = get_u16(bytes + 6);
+	image.width = get_u32(bytes + 8);
+	image.height = get_u32(bytes + 12);
+	image.pixels = bytes + HEADER_SIZE;
+	return image.width > 0 && (size - HEADER_SIZE) / 4 / image.width >= image.height;
+}
+
+// The samples are used in place, so this only works on little-endian
+// machines, which is every platform the game ships on, and needs data to be
+// 2-byte aligned, which the pack and heap buffers both are.
+bool read_baked_sound(const void *data, size_t size, BakedSound &sound)
+{
+	const unsigned char *bytes = (const unsigned char *)data;
+	if (size < HEADER_SIZE || std::memcmp(bytes, SOUND_MAGIC, 4) != 0 || get_u16(bytes + 4) != VERSION)
+	{
+		return false;
+	}
+
+	sound.channels = get_u16(bytes + 6);
+	sound.sampleRate = get_u32(bytes + 8);
+	sound.sampleCount = get_u32(bytes + 12);
+	sound.samples = (const short *)(bytes + HEADER_SIZE);
+	return sound.channels > 0 && (size - HEADER_SIZE) / 2 >= sound.sampleCount;
+}
+
+static bool write_baked(const char *path, const unsigned char *header, const void *data, size_t size)
+{
+	FILE *file = std::fopen(path, "wb");
+	if (!file)
+	{
+		return false;
+	}
+
+	std::fwrite(header, 1, HEADER_SIZE, file);
+	std::fwrite(data, 1, size, file);
+	bool ok = !std::ferror(file);
+	return std::fclose(file) == 0 && ok;
+}
+
+// Writes width * height RGBA pixels, multiplying alpha in if premultiply is set.
+bool write_baked_image(const char *path, unsigned width, unsigned height, const unsigned char *pixels, bool premultiply)
+{
+	unsigned char header[HEADER_SIZE];
+	std::memcpy(header, IMAGE_MAGIC, 4);
+	put_u16(header + 4, VERSION);
+	put_u16(header + 6, premultiply ? BAKED_PREMULTIPLIED : 0);
+	put_u32(header + 8, width);
+	put_u32(header + 12, height);
+
+	size_t size = (size_t)width * height * 4;
+	if (!premultiply)
+	{
+		return write_baked(path, header, pixels, size);
+	}
+
+	std::vector<unsigned char> scaled(pixels, pixels + size);
+	for (size_t i = 0; i < size; i += 4)
+	{
+		unsigned alpha = scaled[i + 3];
+		for (size_t c = 0; c < 3; c++)
+		{
+			scaled[i + c] = (unsigned char)((scaled[i + c] * alpha + 127) / 255);
+		}
+	}
+	return write_baked(path, header, scaled.data(), size);
+}
+
+// Writes sampleCount interleaved samples; the host must be little endian, as
+// for reading.
+bool write_baked_sound(const char *path, const short *samples, unsigned sampleCount, unsigned channels, unsigned sampleRate)
+{
+	unsigned char header[HEADER_SIZE];
+	std::memcpy(header, SOUND_MAGIC, 4);
+	put_u16(header + 4, VERSION);
+	put_u16(header + 6, channels);
+	put_u32(header + 8, sampleRate);
+	put_u32(header + 12, sampleCount);
+	return write_baked(path, header, samples, (size_t)sampleCount * 2);
+}
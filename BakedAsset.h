@@ -0,0 +1,39 @@
+#pragma once
+#include <cstddef>
+#include <string>
+
+// Decoded assets, baked ahead of time so startup copies pixels and samples
+// instead of running the PNG, JPEG and WAV decoders. A baked file sits next to
+// its original with ".raw" appended (explosion.png.raw) and is a 16-byte
+// header followed by the data, little endian:
+//
+//   image: "ASRI", u16 version, u16 flags, u32 width, u32 height, then
+//          width * height RGBA pixels, rows top to bottom
+//   sound: "ASRP", u16 version, u16 channels, u32 sample rate, u32 sample
+//          count, then interleaved 16-bit samples
+//
+// Readers point into the given bytes and copy nothing.
+
+// alpha is already multiplied into the colour
+static const unsigned BAKED_PREMULTIPLIED = 1;
+
+struct BakedImage
+{
+	unsigned width, height;
+	unsigned flags;
+	const unsigned char *pixels;
+};
+
+struct BakedSound
+{
+	unsigned channels;
+	unsigned sampleRate;
+	unsigned sampleCount;
+	const short *samples;
+};
+
+std::string baked_path(const std::string &);
+bool read_baked_image(const void *, size_t, BakedImage &);
+bool read_baked_sound(const void *, size_t, BakedSound &);
+bool write_baked_image(const char *, unsigned, unsigned, const unsigned char *, bool);
+bool write_baked_sound(const char *, const short *, unsigned, unsigned, unsigned);
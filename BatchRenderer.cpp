@@ -0,0 +1,41 @@
+#include "BatchRenderer.h"
+
+BatchRenderer::BatchRenderer()
+{
+	this->vertices.setPrimitiveType(Quads);
+	this->texture = nullptr;
+}
+
+// Starts a new batch; the old vertices are dropped but their memory is kept.
+void BatchRenderer::begin(const Texture &texture)
+{
+	this->texture = &texture;
+	this->vertices.clear();
+}
+
+// Adds a quad centred on (x, y) showing the given part of the texture.
+void BatchRenderer::add(float x, float y, float halfWidth, float halfHeight, const IntRect &rect)
+{
+	float left = (float)rect.left;
+	float top = (float)rect.top;
+	float right = left + rect.width;
+	float bottom = top + rect.height;
+
+	this->vertices.append(Vertex(Vector2f(x - halfWidth, y - halfHeight), Vector2f(left, top)));
+	this->vertices.append(Vertex(Vector2f(x + halfWidth, y - halfHeight), Vector2f(right, top)));
+	this->vertices.append(Vertex(Vector2f(x + halfWidth, y + halfHeight), Vector2f(right, bottom)));
+	this->vertices.append(Vertex(Vector2f(x - halfWidth, y + halfHeight), Vector2f(left, bottom)));
+}
+
+void BatchRenderer::draw(RenderTarget &target) const
+{
+	if (this->vertices.getVertexCount() == 0)
+	{
+		return;
+	}
+	target.draw(this->vertices, RenderStates(this->texture));
+}
+
+BatchRenderer::~BatchRenderer()
+{
+}
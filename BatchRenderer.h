@@ -0,0 +1,22 @@
+#pragma once
+#include <SFML/Graphics.hpp>
+
+using namespace sf;
+
+// Collects textured quads that share one texture (normally the sprite atlas)
+// and draws them with a single draw call. Call begin() every frame, add() once
+// per object, then draw(). The vertex buffer keeps its capacity between
+// frames, so after the first few frames nothing is allocated.
+class BatchRenderer
+{
+private:
+	VertexArray vertices;
+	const Texture *texture;
+
+public:
+	BatchRenderer();
+	void begin(const Texture &);
+	void add(float, float, float, float, const IntRect &);
+	void draw(RenderTarget &) const;
+	~BatchRenderer();
+};
@@ -0,0 +1,578 @@
+// Microbenchmarks for the per-frame simulation functions at growing entity
+// counts. Every case starts from the same seeded world, so numbers from two
+// builds can be compared directly. The move_* and narrow_* cases compare the
+// SIMD kernels with the code they replaced, and the run fails if a kernel
+// gives different results from the scalar path.
+//
+// usage: asteroid_bench [--json FILE] [--max-asteroids N] [--min-time SECONDS] [--seed N]
+
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <string>
+#include <vector>
+
+#include "Integrate.h"
+#include "NarrowPhase.h"
+#include "World.h"
+
+// Every heap allocation in the process goes through here so each case can
+// report how many allocations it made per call.
+static std::atomic<long long> allocationCount(0);
+
+void *operator new(std::size_t size)
+{
+	allocationCount.fetch_add(1, std::memory_order_relaxed);
+	void *memory = std::malloc(size ? size : 1);
+	if (memory == nullptr)
+	{
+		throw std::bad_alloc();
+	}
+	return memory;
+}
+
+void *operator new[](std::size_t size)
+{
+	return operator new(size);
+}
+
+void operator delete(void *memory) noexcept
+{
+	std::free(memory);
+}
+
+void operator delete[](void *memory) noexcept
+{
+	std::free(memory);
+}
+
+void operator delete(void *memory, std::size_t) noexcept
+{
+	std::free(memory);
+}
+
+void operator delete[](void *memory, std::size_t) noexcept
+{
+	std::free(memory);
+}
+
+struct BenchResult
+{
+	std::string name;
+	int asteroids;
+	int bullets;
+	int iterations;
+	int callsPerIteration;
+	double nsPerCall;
+	double nsPerEntity;
+	double allocsPerCall;
+	double entitiesPerSecond;
+};
+
+struct BenchOptions
+{
+	double minTime;
+	int minIterations;
+	int maxIterations;
+};
+
+const float benchDt = 1.f / 60;
+
+// Builds a world with the asteroids and bullets spread over the whole screen.
+// The ship is parked far outside the playfield so the collision pass never
+// stops early on a crash.
+World seed_world(int asteroidCount, int bulletCount, unsigned seed)
+{
+	Random layout(seed, RandomEffects);
+
+	World world;
+	world.seed(seed);
+	world.asteroidsPerWave = asteroidCount;
+	world.restart();
+
+	for (size_t i = 0; i < world.asteroids.size(); i++)
+	{
+		world.asteroids.x[i] = layout.below(GAMEWIDTH);
+		world.asteroids.y[i] = layout.below(GAMEHEIGHT);
+	}
+
+	world.bullets.reserve(bulletCount);
+	unsigned lifetime = world.bulletLifetimeTicks(benchDt);
+	for (int j = 0; j < bulletCount; j++)
+	{
+		float angle = layout.angle();
+		float x = layout.below(GAMEWIDTH);
+		float y = layout.below(GAMEHEIGHT);
+		size_t index = world.bullets.add(KindBullet, x, y,
+			std::sin(angle), -std::cos(angle),
+			world.bulletVelocity, world.bulletRadius);
+
+		// spread the spawn ticks over the last lifetime, oldest first as
+		// shooting leaves them, so expiry is gradual
+		world.bullets.born[index] = (unsigned)((long long)j * lifetime / bulletCount) + 1 - lifetime;
+	}
+
+	world.ship.x = -100 * GAMEWIDTH;
+	world.ship.y = -100 * GAMEHEIGHT;
+
+	// the layout is where everything starts the tick, not a move across the
+	// screen for the swept tests to cover
+	world.asteroids.savePositions();
+	world.bullets.savePositions();
+
+	return world;
+}
+
+// The per-entity branches move_asteroids() used before the integrate kernels,
+// kept as the baseline they are compared against.
+void move_asteroids_branchy(EntityStore &asteroids, float dt)
+{
+	for (size_t i = 0; i < asteroids.size(); i++)
+	{
+		float astX = asteroids.x[i];
+		float astY = asteroids.y[i];
+		float astRadius = asteroids.radius[i];
+
+		if (astY + astRadius <= 0)
+		{
+			asteroids.y[i] = GAMEHEIGHT - astRadius - 1;
+		}
+		else if (astY + astRadius >= GAMEHEIGHT)
+		{
+			asteroids.y[i] = -astRadius + 1;
+		}
+		else if (astX + astRadius <= 0)
+		{
+			asteroids.x[i] = GAMEWIDTH - astRadius - 1;
+		}
+		else if (astX + astRadius >= GAMEWIDTH)
+		{
+			asteroids.x[i] = -astRadius + 1;
+		}
+		asteroids.x[i] += asteroids.dirX[i] * asteroids.velocity[i] * dt;
+		asteroids.y[i] += asteroids.dirY[i] * asteroids.velocity[i] * dt;
+	}
+}
+
+// Runs one integrate kernel over a copy of the asteroids and checks that it
+// lands every asteroid exactly where the branchy version does.
+bool kernel_matches(const World &seeded, IntegrateKernel kernel)
+{
+	EntityStore expected = seeded.asteroids;
+	EntityStore actual = seeded.asteroids;
+
+	// push some asteroids over each edge so every wrap rule is exercised
+	for (size_t i = 0; i < actual.size(); i += 5)
+	{
+		float edge = (i / 5) % 2 ? -actual.radius[i] - 1 : GAMEWIDTH + 1.f;
+		if ((i / 10) % 2)
+		{
+			expected.y[i] = actual.y[i] = edge * GAMEHEIGHT / GAMEWIDTH;
+		}
+		else
+		{
+			expected.x[i] = actual.x[i] = edge;
+		}
+	}
+
+	move_asteroids_branchy(expected, benchDt);
+	IntegrateArgs args = { actual.x.data(), actual.y.data(), actual.dirX.data(), actual.dirY.data(),
+		actual.velocity.data(), actual.radius.data(), benchDt, GAMEWIDTH, GAMEHEIGHT, true };
+	kernel(args, 0, actual.size());
+
+	return std::memcmp(expected.x.data(), actual.x.data(), actual.size() * sizeof(float)) == 0
+		&& std::memcmp(expected.y.data(), actual.y.data(), actual.size() * sizeof(float)) == 0;
+}
+
+// The per-pair test is_collided() used before the batched narrow phase.
+bool is_collided_sqrt(float x1, float y1, float r1, float x2, float y2, float r2)
+{
+	float distance = sqrt(pow(x2 - x1, 2) + pow(y2 - y1, 2));
+
+	return distance <= (r1 + r2);
+}
+
+// Runs one circle_hits kernel for a few query circles and checks that its
+// masks match the scalar version's.
+bool hits_match(const World &seeded, CircleHitsKernel kernel)
+{
+	const EntityStore &asteroids = seeded.asteroids;
+	std::vector<unsigned char> expected(asteroids.size()), actual(asteroids.size());
+
+	for (size_t q = 0; q < asteroids.size(); q += 97)
+	{
+		size_t expectedHits = circle_hits_scalar(asteroids.x[q], asteroids.y[q], asteroids.radius[q],
+			asteroids.x.data(), asteroids.y.data(), asteroids.radius.data(), asteroids.size(), expected.data());
+		size_t actualHits = kernel(asteroids.x[q], asteroids.y[q], asteroids.radius[q],
+			asteroids.x.data(), asteroids.y.data(), asteroids.radius.data(), asteroids.size(), actual.data());
+
+		if (expectedHits != actualHits || expected != actual)
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+// Times body(world) on a fresh copy of the seeded world until both the minimum
+// time and the minimum iteration count are reached. Copying the seed is not
+// timed, and the copy keeps the worker pool and contact buffers the untimed
+// first call set up, as a running game would. body returns how many entities
+// it processed, used for ns/entity.
+template <typename Body>
+BenchResult run_case(const char *name, const World &seeded, int bulletCount, int callsPerIteration, const BenchOptions &options, Body body)
+{
+	World world = seeded;
+	body(world);
+
+	double totalNs = 0;
+	long long totalAllocs = 0;
+	long long totalEntities = 0;
+	int iterations = 0;
+
+	while (iterations < options.maxIterations && (totalNs < options.minTime * 1e9 || iterations < options.minIterations))
+	{
+		world.restoreFrom(seeded);
+
+		long long allocsBefore = allocationCount.load(std::memory_order_relaxed);
+		std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+		size_t entities = body(world);
+
+		std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+		long long allocsAfter = allocationCount.load(std::memory_order_relaxed);
+
+		totalNs += std::chrono::duration<double, std::nano>(end - start).count();
+		totalAllocs += allocsAfter - allocsBefore;
+		totalEntities += entities;
+		iterations++;
+	}
+
+	BenchResult result;
+	result.name = name;
+	result.asteroids = (int)seeded.asteroids.size();
+	result.bullets = bulletCount;
+	result.iterations = iterations;
+	result.callsPerIteration = callsPerIteration;
+	result.nsPerCall = totalNs / ((double)iterations * callsPerIteration);
+	result.nsPerEntity = totalEntities > 0 ? totalNs / totalEntities : 0;
+	result.allocsPerCall = (double)totalAllocs / ((double)iterations * callsPerIteration);
+	result.entitiesPerSecond = totalNs > 0 ? totalEntities * 1e9 / totalNs : 0;
+
+	std::printf("%-16s %8d %8d %6d %14.0f %12.2f %10.2f %14.0f\n",
+		result.name.c_str(), result.asteroids, result.bullets, result.iterations,
+		result.nsPerCall, result.nsPerEntity, result.allocsPerCall, result.entitiesPerSecond);
+	std::fflush(stdout);
+
+	return result;
+}
+
+void write_json(const char *path, const std::vector<BenchResult> &results)
+{
+	FILE *file = std::fopen(path, "w");
+	if (file == nullptr)
+	{
+		std::fprintf(stderr, "cannot write %s\n", path);
+		return;
+	}
+
+	std::fprintf(file, "[\n");
+	for (size_t i = 0; i < results.size(); i++)
+	{
+		const BenchResult &r = results[i];
+		std::fprintf(file,
+			"  {\"case\": \"%s\", \"asteroids\": %d, \"bullets\": %d, \"iterations\": %d, \"calls_per_iteration\": %d, "
+			"\"ns_per_call\": %.1f, \"ns_per_entity\": %.3f, \"allocs_per_call\": %.3f, \"entities_per_second\": %.0f}%s\n",
+			r.name.c_str(), r.asteroids, r.bullets, r.iterations, r.callsPerIteration,
+			r.nsPerCall, r.nsPerEntity, r.allocsPerCall, r.entitiesPerSecond,
+			i + 1 < results.size() ? "," : "");
+	}
+	std::fprintf(file, "]\n");
+	std::fclose(file);
+}
+
+int main(int argc, char **argv)
+{
+	const char *jsonPath = nullptr;
+	int maxAsteroids = 100000;
+	unsigned seed = 1;
+
+	BenchOptions options;
+	options.minTime = 0.25;
+	options.minIterations = 1;
+	options.maxIterations = 100000;
+
+	for (int i = 1; i < argc; i++)
+	{
+		if (std::strcmp(argv[i], "--json") == 0 && i + 1 < argc)
+		{
+			jsonPath = argv[++i];
+		}
+		else if (std::strcmp(argv[i], "--max-asteroids") == 0 && i + 1 < argc)
+		{
+			maxAsteroids = std::atoi(argv[++i]);
+		}
+		else if (std::strcmp(argv[i], "--min-time") == 0 && i + 1 < argc)
+		{
+			options.minTime = std::atof(argv[++i]);
+		}
+		else if (std::strcmp(argv[i], "--seed") == 0 && i + 1 < argc)
+		{
+			seed = (unsigned)std::strtoul(argv[++i], nullptr, 10);
+		}
+		else
+		{
+			std::fprintf(stderr, "usage: %s [--json FILE] [--max-asteroids N] [--min-time SECONDS] [--seed N]\n", argv[0]);
+			return 1;
+		}
+	}
+
+	const int asteroidCounts[] = { 12, 1000, 10000, 100000 };
+	const int bulletCounts[] = { 0, 256, 4096 };
+	const int hitsPerIteration = 64;
+	const int shotsPerIteration = 256;
+
+	Input idle = Input();
+	std::vector<BenchResult> results;
+	bool kernelsMatch = true;
+
+	const int queriesPerIteration = 64;
+
+	std::printf("simd path: %s\n", simd_path_name(simd_path()));
+
+	std::printf("%-16s %8s %8s %6s %14s %12s %10s %14s\n",
+		"case", "asteroids", "bullets", "iters", "ns/call", "ns/entity", "allocs/call", "entities/s");
+
+	for (int asteroidCount : asteroidCounts)
+	{
+		if (asteroidCount > maxAsteroids)
+		{
+			continue;
+		}
+
+		for (int bulletCount : bulletCounts)
+		{
+			World seeded = seed_world(asteroidCount, bulletCount, seed);
+
+			results.push_back(run_case("update_state", seeded, bulletCount, 1, options, [&](World &world)
+			{
+				size_t entities = world.asteroids.size() + world.bullets.count();
+				world.update_state(idle, benchDt);
+				return entities;
+			}));
+
+			results.push_back(run_case("move_asteroids", seeded, bulletCount, 1, options, [&](World &world)
+			{
+				world.move_asteroids(benchDt);
+				return world.asteroids.size();
+			}));
+
+			// the movement kernels only touch asteroids, so one bullet count is enough
+			if (bulletCount == 0)
+			{
+				results.push_back(run_case("move_branchy", seeded, bulletCount, 1, options, [&](World &world)
+				{
+					move_asteroids_branchy(world.asteroids, benchDt);
+					return world.asteroids.size();
+				}));
+
+				for (int path = SimdScalar; path < SimdPathCount; path++)
+				{
+					if (!simd_path_supported(path))
+					{
+						continue;
+					}
+
+					IntegrateKernel kernel = integrate_kernel(path);
+					if (!kernel_matches(seeded, kernel))
+					{
+						std::fprintf(stderr, "%s kernel does not match the branchy path\n", simd_path_name(path));
+						kernelsMatch = false;
+					}
+
+					std::string name = std::string("move_") + simd_path_name(path);
+					results.push_back(run_case(name.c_str(), seeded, bulletCount, 1, options, [&](World &world)
+					{
+						EntityStore &asteroids = world.asteroids;
+						IntegrateArgs args = { asteroids.x.data(), asteroids.y.data(), asteroids.dirX.data(), asteroids.dirY.data(),
+							asteroids.velocity.data(), asteroids.radius.data(), benchDt, GAMEWIDTH, GAMEHEIGHT, true };
+						kernel(args, 0, asteroids.size());
+						return asteroids.size();
+					}));
+				}
+
+				// narrow phase: queriesPerIteration circles against every asteroid, so
+				// ns/entity is per tested pair
+				results.push_back(run_case("narrow_sqrt", seeded, bulletCount, queriesPerIteration, options, [&](World &world)
+				{
+					const EntityStore &asteroids = world.asteroids;
+					size_t hits = 0;
+					for (int q = 0; q < queriesPerIteration; q++)
+					{
+						size_t query = (q * 7919) % asteroids.size();
+						for (size_t k = 0; k < asteroids.size(); k++)
+						{
+							hits += is_collided_sqrt(asteroids.x[query], asteroids.y[query], asteroids.radius[query],
+								asteroids.x[k], asteroids.y[k], asteroids.radius[k]);
+						}
+					}
+					world.score = (int)hits;
+					return asteroids.size() * queriesPerIteration;
+				}));
+
+				std::vector<unsigned char> hitMask(seeded.asteroids.size());
+				for (int path = SimdScalar; path < SimdPathCount; path++)
+				{
+					if (!simd_path_supported(path))
+					{
+						continue;
+					}
+
+					CircleHitsKernel kernel = circle_hits_kernel(path);
+					if (!hits_match(seeded, kernel))
+					{
+						std::fprintf(stderr, "%s narrow phase does not match the scalar one\n", simd_path_name(path));
+						kernelsMatch = false;
+					}
+
+					std::string name = std::string("narrow_") + simd_path_name(path);
+					results.push_back(run_case(name.c_str(), seeded, bulletCount, queriesPerIteration, options, [&](World &world)
+					{
+						const EntityStore &asteroids = world.asteroids;
+						size_t hits = 0;
+						for (int q = 0; q < queriesPerIteration; q++)
+						{
+							size_t query = (q * 7919) % asteroids.size();
+							hits += kernel(asteroids.x[query], asteroids.y[query], asteroids.radius[query],
+								asteroids.x.data(), asteroids.y.data(), asteroids.radius.data(), asteroids.size(), hitMask.data());
+						}
+						world.score = (int)hits;
+						return asteroids.size() * queriesPerIteration;
+					}));
+				}
+			}
+
+			results.push_back(run_case("move_bullets", seeded, bulletCount, 1, options, [&](World &world)
+			{
+				size_t entities = world.bullets.count();
+				world.move_bullets(benchDt);
+				return entities;
+			}));
+
+			results.push_back(run_case("ck_optimize", seeded, bulletCount, 1, options, [&](World &world)
+			{
+				size_t entities = world.asteroids.size() + world.bullets.count();
+				world.ck_optimize();
+				return entities;
+			}));
+
+			// sweep and prune instead of the grid, warmed up once so the timed
+			// build starts from the previous tick's order like it does in the game
+			World warmSweep = seeded;
+			warmSweep.broadphase = BroadphaseSweep;
+			warmSweep.buildBroadphase();
+			results.push_back(run_case("ck_optimize_sap", warmSweep, bulletCount, 1, options, [&](World &world)
+			{
+				size_t entities = world.asteroids.size() + world.bullets.count();
+				world.ck_optimize();
+				return entities;
+			}));
+
+			// A sweep-and-prune build a tick after the previous one, on a world
+			// that keeps running across iterations: everything moves a little,
+			// one asteroid is destroyed, which moves every later one to a new
+			// index, and one spawns. Shows whether the build still finds last
+			// tick's order and takes the insertion sort.
+			World ticking = seeded;
+			Random spawns(seed, RandomEffects);
+			SweepAndPrune rebuilt;
+			int builds = 0, fullSorts = 0;
+			results.push_back(run_case("sap_rebuild", seeded, bulletCount, 1, options, [&](World &)
+			{
+				EntityStore &asteroids = ticking.asteroids;
+				ticking.move_asteroids(benchDt);
+				if (asteroids.size() > 0)
+				{
+					asteroids.kill(spawns.below((uint32_t)asteroids.size()));
+					asteroids.compact();
+				}
+				float heading = spawns.angle();
+				asteroids.add(KindMediumAst, spawns.below(GAMEWIDTH), spawns.below(GAMEHEIGHT),
+					std::sin(heading), -std::cos(heading), ticking.astroidVelocity, ticking.mAstRadius);
+
+				rebuilt.build(asteroids.x.data(), asteroids.y.data(), asteroids.radius.data(), asteroids.id.data(), asteroids.size());
+				builds++;
+				fullSorts += rebuilt.wasFullSort();
+				return asteroids.size();
+			}));
+			std::printf("  sap_rebuild: insertion sort in %d of %d builds, %zu slot moves in the last\n",
+				builds - fullSorts, builds, rebuilt.getLastSwaps());
+
+			// the same pass on fixed thread counts, the first with the worker
+			// pool switched off
+			const int threadCounts[] = { 1, 2, 4 };
+			const char *threadCases[] = { "ck_optimize_st", "ck_optimize_t2", "ck_optimize_t4" };
+			for (int t = 0; t < 3; t++)
+			{
+				World threaded = seeded;
+				threaded.collisionThreads = threadCounts[t];
+				results.push_back(run_case(threadCases[t], threaded, bulletCount, 1, options, [&](World &world)
+				{
+					size_t entities = world.asteroids.size() + world.bullets.count();
+					world.ck_optimize();
+					return entities;
+				}));
+			}
+
+			results.push_back(run_case("ast_get_hit", seeded, bulletCount, hitsPerIteration, options, [&](World &world)
+			{
+				int count = (int)world.asteroids.size();
+				for (int k = 0; k < hitsPerIteration; k++)
+				{
+					world.ast_get_hit((k * 7919) % count);
+				}
+				world.asteroids.compact();
+				return (size_t)hitsPerIteration;
+			}));
+
+			// a whole wave of asteroidCount, random numbers included
+			results.push_back(run_case("create_ast", seeded, bulletCount, 1, options, [&](World &world)
+			{
+				world.asteroids.clear();
+				world.create_ast();
+				return world.asteroids.size();
+			}));
+
+			results.push_back(run_case("bullet_spawn", seeded, bulletCount, shotsPerIteration, options, [&](World &world)
+			{
+				for (int k = 0; k < shotsPerIteration; k++)
+				{
+					world.shoot();
+				}
+				return (size_t)shotsPerIteration;
+			}));
+
+			if (bulletCount > 0)
+			{
+				results.push_back(run_case("bullet_expiry", seeded, bulletCount, 1, options, [&](World &world)
+				{
+					size_t entities = world.bullets.count();
+					world.tick += world.bulletLifetimeTicks(benchDt);
+					world.move_bullets(benchDt);
+					return entities;
+				}));
+			}
+		}
+	}
+
+	if (jsonPath != nullptr)
+	{
+		write_json(jsonPath, results);
+	}
+
+	return kernelsMatch ? 0 : 1;
+}
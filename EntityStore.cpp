@@ -0,0 +1,169 @@
+#include "EntityStore.h"
+
+#include <algorithm>
+
+EntityStore::EntityStore()
+{
+	this->nextId = 0;
+	this->head = 0;
+}
+
+size_t EntityStore::size() const
+{
+	return this->x.size();
+}
+
+// entities from head on; the ones before it are dropped
+size_t EntityStore::count() const
+{
+	return this->x.size() - this->head;
+}
+
+// Appends one entity and returns its index. born starts at zero; bullets set it
+// to the spawn tick right after adding.
+size_t EntityStore::add(unsigned char kind, float x, float y, float dirX, float dirY, float velocity, float radius)
+{
+	this->x.push_back(x);
+	this->y.push_back(y);
+	this->prevX.push_back(x);
+	this->prevY.push_back(y);
+	this->dirX.push_back(dirX);
+	this->dirY.push_back(dirY);
+	this->velocity.push_back(velocity);
+	this->radius.push_back(radius);
+	this->born.push_back(0);
+	this->kind.push_back(kind);
+	this->alive.push_back(1);
+	this->id.push_back(this->nextId++);
+
+	return this->x.size() - 1;
+}
+
+void EntityStore::kill(size_t index)
+{
+	this->alive[index] = 0;
+}
+
+void EntityStore::savePositions()
+{
+	std::copy(this->x.begin(), this->x.end(), this->prevX.begin());
+	std::copy(this->y.begin(), this->y.end(), this->prevY.begin());
+}
+
+void EntityStore::compact()
+{
+	size_t count = this->size();
+	size_t kept = this->head;
+
+	for (size_t i = this->head; i < count; i++)
+	{
+		if (!this->alive[i])
+		{
+			continue;
+		}
+
+		if (kept != i)
+		{
+			this->x[kept] = this->x[i];
+			this->y[kept] = this->y[i];
+			this->prevX[kept] = this->prevX[i];
+			this->prevY[kept] = this->prevY[i];
+			this->dirX[kept] = this->dirX[i];
+			this->dirY[kept] = this->dirY[i];
+			this->velocity[kept] = this->velocity[i];
+			this->radius[kept] = this->radius[i];
+			this->born[kept] = this->born[i];
+			this->kind[kept] = this->kind[i];
+			this->alive[kept] = 1;
+			this->id[kept] = this->id[i];
+		}
+		kept++;
+	}
+
+	if (kept == count)
+	{
+		return;
+	}
+
+	this->x.resize(kept);
+	this->y.resize(kept);
+	this->prevX.resize(kept);
+	this->prevY.resize(kept);
+	this->dirX.resize(kept);
+	this->dirY.resize(kept);
+	this->velocity.resize(kept);
+	this->radius.resize(kept);
+	this->born.resize(kept);
+	this->kind.resize(kept);
+	this->alive.resize(kept);
+	this->id.resize(kept);
+}
+
+// Drops the count entities from head on, keeping the order of the rest, for
+// stores kept in spawn order that expire from the front. The columns are only
+// shifted down, one block move each, once the dropped entities are at least
+// half the store, which the drops since the last shift have paid for.
+void EntityStore::removeFront(size_t count)
+{
+	for (size_t i = this->head; i < this->head + count; i++)
+	{
+		this->alive[i] = 0;
+	}
+	this->head += count;
+	if (this->head < this->size() - this->head)
+	{
+		return;
+	}
+
+	count = this->head;
+	this->head = 0;
+	this->x.erase(this->x.begin(), this->x.begin() + count);
+	this->y.erase(this->y.begin(), this->y.begin() + count);
+	this->prevX.erase(this->prevX.begin(), this->prevX.begin() + count);
+	this->prevY.erase(this->prevY.begin(), this->prevY.begin() + count);
+	this->dirX.erase(this->dirX.begin(), this->dirX.begin() + count);
+	this->dirY.erase(this->dirY.begin(), this->dirY.begin() + count);
+	this->velocity.erase(this->velocity.begin(), this->velocity.begin() + count);
+	this->radius.erase(this->radius.begin(), this->radius.begin() + count);
+	this->born.erase(this->born.begin(), this->born.begin() + count);
+	this->kind.erase(this->kind.begin(), this->kind.begin() + count);
+	this->alive.erase(this->alive.begin(), this->alive.begin() + count);
+	this->id.erase(this->id.begin(), this->id.begin() + count);
+}
+
+void EntityStore::clear()
+{
+	this->head = 0;
+	this->x.clear();
+	this->y.clear();
+	this->prevX.clear();
+	this->prevY.clear();
+	this->dirX.clear();
+	this->dirY.clear();
+	this->velocity.clear();
+	this->radius.clear();
+	this->born.clear();
+	this->kind.clear();
+	this->alive.clear();
+	this->id.clear();
+}
+
+void EntityStore::reserve(size_t count)
+{
+	this->x.reserve(count);
+	this->y.reserve(count);
+	this->prevX.reserve(count);
+	this->prevY.reserve(count);
+	this->dirX.reserve(count);
+	this->dirY.reserve(count);
+	this->velocity.reserve(count);
+	this->radius.reserve(count);
+	this->born.reserve(count);
+	this->kind.reserve(count);
+	this->alive.reserve(count);
+	this->id.reserve(count);
+}
+
+EntityStore::~EntityStore()
+{
+}
@@ -0,0 +1,61 @@
+#pragma once
+#include <vector>
+#include <cstddef>
+
+// Kind tag of every colliding thing. The ship is not kept in a store but has a
+// kind too, so its contacts go through the same dispatch table in World.
+enum EntityKind
+{
+	KindSmallAst,
+	KindMediumAst,
+	KindBigAst,
+	KindBullet,
+	KindShip,
+	KindCount
+};
+
+// Structure-of-arrays storage for the moving objects (asteroids and bullets).
+// Every column has one entry per entity, so the per-frame sweeps in
+// update_state() and ck_optimize() walk plain float arrays instead of chasing
+// pointers into CircleShapes. Entities are removed by clearing their alive flag
+// and calling compact() once the sweep is over; compact() keeps the order.
+// prevX/prevY hold the position at the start of the current tick so the
+// renderer can interpolate between ticks. born is the World::tick an entity
+// was spawned on. id numbers entities in the order they were added and is
+// never reused, so it increases along the store and lets a broadphase find
+// last tick's entities again after compaction has moved them.
+//
+// removeFront() does not move anything: it kills the entities and advances
+// head past them, and they are only erased once they make up half the store,
+// so dropping costs O(dropped) amortised. The entities before head are dead
+// and stay out of every sweep, which runs from head to size().
+class EntityStore
+{
+public:
+	std::vector<float> x;
+	std::vector<float> y;
+	std::vector<float> prevX;
+	std::vector<float> prevY;
+	std::vector<float> dirX;
+	std::vector<float> dirY;
+	std::vector<float> velocity;
+	std::vector<float> radius;
+	std::vector<unsigned> born;
+	std::vector<unsigned char> kind;
+	std::vector<unsigned char> alive;
+	std::vector<unsigned> id;
+	unsigned nextId;
+	size_t head;
+
+	EntityStore();
+	size_t size() const;
+	size_t count() const;
+	size_t add(unsigned char, float, float, float, float, float, float);
+	void kill(size_t);
+	void savePositions();
+	void compact();
+	void removeFront(size_t);
+	void clear();
+	void reserve(size_t);
+	~EntityStore();
+};
@@ -0,0 +1,59 @@
+#include "FixedTimestep.h"
+
+#include <cmath>
+
+// Tick rates come from the command line and from recordings; zero, negative,
+// infinite or NaN rates would make the tick length meaningless.
+bool valid_tick_rate(float rate)
+{
+	return rate > 0 && std::isfinite(rate);
+}
+
+FixedTimestep::FixedTimestep(float rate, int maxTicks)
+{
+	this->accumulator = 0.f;
+	this->maxTicks = maxTicks;
+	this->setRate(rate);
+}
+
+void FixedTimestep::setRate(float rate)
+{
+	this->tickLength = 1.f / rate;
+}
+
+float FixedTimestep::getTickLength() const
+{
+	return this->tickLength;
+}
+
+// Adds one frame's worth of real time and returns how many ticks to run now.
+int FixedTimestep::advance(float frameTime)
+{
+	this->accumulator += frameTime;
+
+	int ticks = (int)(this->accumulator / this->tickLength);
+	if (ticks > this->maxTicks)
+	{
+		ticks = this->maxTicks;
+		this->accumulator = 0.f;
+		return ticks;
+	}
+
+	this->accumulator -= ticks * this->tickLength;
+	return ticks;
+}
+
+// How far the render time is between the last tick and the next one, in [0, 1).
+float FixedTimestep::alpha() const
+{
+	return this->accumulator / this->tickLength;
+}
+
+void FixedTimestep::reset()
+{
+	this->accumulator = 0.f;
+}
+
+FixedTimestep::~FixedTimestep()
+{
+}
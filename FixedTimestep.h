@@ -0,0 +1,27 @@
+#pragma once
+
+const float DEFAULT_TICK_RATE = 120.f;
+const int DEFAULT_MAX_CATCHUP_TICKS = 8;
+
+bool valid_tick_rate(float);
+
+// Accumulates real frame time and hands it out as whole simulation ticks of a
+// fixed length, so the simulation behaves the same at any display rate and a
+// hitch can never turn into one huge step. After a long stall at most
+// maxTicks ticks are run and the rest of the backlog is dropped.
+class FixedTimestep
+{
+private:
+	float tickLength;
+	float accumulator;
+	int maxTicks;
+
+public:
+	FixedTimestep(float, int);
+	void setRate(float);
+	float getTickLength() const;
+	int advance(float);
+	float alpha() const;
+	void reset();
+	~FixedTimestep();
+};
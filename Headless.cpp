@@ -0,0 +1,265 @@
+// Runs the simulation without a window or audio device, driven by a simple
+// bot, and prints a summary. Meant for profiling and soak runs on machines
+// that have no display.
+//
+// The checksum covers the final state of the world, so two runs with the same
+// arguments, for example with different collision thread counts or
+// broadphases, can be compared.
+//
+// --record FILE saves the bot's session, and --replay FILE plays a session
+// recorded here or in the game at full speed instead of running the bot; the
+// seed, tick rate and wave size then come from the recording and the session
+// runs to its end.
+//
+// usage: asteroid_headless [--record FILE | --replay FILE] [ticks] [seed] [asteroids per wave] [tick rate] [collision threads] [grid|sweep]
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <vector>
+
+#include "FixedTimestep.h"
+#include "InputRecording.h"
+#include "Profiler.h"
+#include "TraceRecorder.h"
+#include "World.h"
+
+// Aims at the nearest asteroid, fires in short bursts and strafes through the
+// eight directions, changing every second of game time at the default rate.
+Input bot_input(const World &world, int frame)
+{
+	Input input = Input();
+
+	float bestDistance = -1;
+	for (size_t i = 0; i < world.asteroids.size(); i++)
+	{
+		float dx = world.asteroids.x[i] - world.ship.x;
+		float dy = world.asteroids.y[i] - world.ship.y;
+		float distance = dx * dx + dy * dy;
+		if (bestDistance < 0 || distance < bestDistance)
+		{
+			bestDistance = distance;
+			input.aimX = world.asteroids.x[i];
+			input.aimY = world.asteroids.y[i];
+		}
+	}
+
+	int heading = (frame / 120) % 9;
+	if (heading == 0 || heading == 1 || heading == 7)
+	{
+		input.buttons |= ButtonUp;
+	}
+	if (heading == 1 || heading == 2 || heading == 3)
+	{
+		input.buttons |= ButtonRight;
+	}
+	if (heading == 3 || heading == 4 || heading == 5)
+	{
+		input.buttons |= ButtonDown;
+	}
+	if (heading == 5 || heading == 6 || heading == 7)
+	{
+		input.buttons |= ButtonLeft;
+	}
+	if (frame % 10 == 0)
+	{
+		input.buttons |= ButtonFire;
+	}
+
+	return input;
+}
+
+// FNV-1a over the raw bytes of a column, from entry first on
+template <typename T>
+unsigned long long hash_column(unsigned long long hash, const std::vector<T> &column, size_t first = 0)
+{
+	const unsigned char *bytes = (const unsigned char *)(column.data() + first);
+	for (size_t i = 0; i < (column.size() - first) * sizeof(T); i++)
+	{
+		hash = (hash ^ bytes[i]) * 1099511628211ULL;
+	}
+	return hash;
+}
+
+unsigned long long world_checksum(const World &world)
+{
+	unsigned long long hash = 14695981039346656037ULL;
+	hash = hash_column(hash, world.asteroids.x);
+	hash = hash_column(hash, world.asteroids.y);
+	hash = hash_column(hash, world.asteroids.dirX);
+	hash = hash_column(hash, world.asteroids.dirY);
+	hash = hash_column(hash, world.asteroids.kind);
+	hash = hash_column(hash, world.bullets.x, world.bullets.head);
+	hash = hash_column(hash, world.bullets.y, world.bullets.head);
+	hash = hash_column(hash, std::vector<int>{ world.score, world.life, world.level });
+	return hash;
+}
+
+int main(int argc, char **argv)
+{
+	InputRecorder recorder;
+	InputReplay replay;
+	const char *recordPath = nullptr;
+	if (argc > 2 && std::strcmp(argv[1], "--record") == 0)
+	{
+		recordPath = argv[2];
+	}
+	else if (argc > 2 && std::strcmp(argv[1], "--replay") == 0 && !replay.open(argv[2]))
+	{
+		std::fprintf(stderr, "cannot read recording %s\n", argv[2]);
+		return 1;
+	}
+	if (argc > 2 && (recordPath || replay.isOpen()))
+	{
+		argc -= 2;
+		argv += 2;
+	}
+
+	int frames = argc > 1 ? std::atoi(argv[1]) : 36000;
+	unsigned seed = argc > 2 ? (unsigned)std::strtoul(argv[2], nullptr, 10) : (unsigned)std::time(0);
+	int perWave = argc > 3 ? std::atoi(argv[3]) : 12;
+	float tickRate = argc > 4 ? (float)std::atof(argv[4]) : DEFAULT_TICK_RATE;
+	int threads = argc > 5 ? std::atoi(argv[5]) : 0;
+	int broadphase = argc > 6 && std::strcmp(argv[6], "sweep") == 0 ? BroadphaseSweep : BroadphaseGrid;
+
+	if (replay.isOpen())
+	{
+		frames = -1;
+		seed = replay.header.seed;
+		tickRate = replay.header.tickRate;
+		perWave = replay.header.asteroidsPerWave;
+	}
+	if (!valid_tick_rate(tickRate))
+	{
+		std::fprintf(stderr, "tick rate must be a positive number of ticks per second, not %g\n", tickRate);
+		return 1;
+	}
+	if (!valid_wave_size(perWave))
+	{
+		std::fprintf(stderr, "asteroids per wave must be 1 to %d, not %d\n", MAX_ASTEROIDS_PER_WAVE, perWave);
+		return 1;
+	}
+	const float dt = 1.f / tickRate;
+
+	RecordingHeader header = { seed, tickRate, perWave };
+	if (recordPath && !recorder.open(recordPath, header))
+	{
+		std::fprintf(stderr, "cannot write recording %s\n", recordPath);
+		return 1;
+	}
+
+	World world;
+	world.seed(seed);
+	world.asteroidsPerWave = perWave;
+	world.collisionThreads = threads;
+	world.broadphase = broadphase;
+	world.restart();
+
+	int deaths = 0, levelsCleared = 0, bestScore = 0;
+	long long shots = 0, explosions = 0;
+	size_t peakAsteroids = 0, peakBullets = 0;
+
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+	int frame = 0;
+	for (; frames < 0 || frame < frames; frame++)
+	{
+		TRACE_SCOPE("tick");
+
+		// like the game, a new one starts with the tick after a game over,
+		// so the restart lands in the recording
+		Input input;
+		bool restarted = false;
+		if (replay.isOpen())
+		{
+			if (!replay.next(input, restarted))
+			{
+				break;
+			}
+		}
+		else
+		{
+			restarted = world.life <= 0;
+			input = bot_input(world, frame);
+		}
+
+		if (restarted)
+		{
+			world.restart();
+		}
+		recorder.write(input, restarted);
+		world.step(input, dt);
+#ifdef ASTEROID_PROFILE
+		profiler.endFrame();
+#endif
+
+		for (size_t i = 0; i < world.events.size(); i++)
+		{
+			switch (world.events[i].type)
+			{
+			case EventShoot:
+				shots++;
+				break;
+			case EventExplode:
+				explosions++;
+				break;
+			case EventLevelUp:
+				levelsCleared++;
+				break;
+			default:
+				break;
+			}
+		}
+
+		if (world.asteroids.size() > peakAsteroids)
+		{
+			peakAsteroids = world.asteroids.size();
+		}
+		if (world.bullets.count() > peakBullets)
+		{
+			peakBullets = world.bullets.count();
+		}
+
+		if (world.life <= 0)
+		{
+			deaths++;
+			if (world.score > bestScore)
+			{
+				bestScore = world.score;
+			}
+		}
+	}
+	frames = frame;
+
+	double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+	if (world.score > bestScore)
+	{
+		bestScore = world.score;
+	}
+
+	std::printf("seed            %u\n", seed);
+	std::printf("broadphase      %s\n", broadphase == BroadphaseSweep ? "sweep" : "grid");
+	std::printf("ticks           %d (%.1f s of game time at %g Hz)\n", frames, frames * dt, tickRate);
+	std::printf("wall time       %.3f s\n", seconds);
+	std::printf("per tick        %.3f us\n", frames > 0 ? seconds * 1e6 / frames : 0.0);
+	std::printf("game overs      %d\n", deaths);
+	std::printf("levels cleared  %d\n", levelsCleared);
+	std::printf("best score      %d\n", bestScore);
+	std::printf("shots fired     %lld\n", shots);
+	std::printf("explosions      %lld\n", explosions);
+	std::printf("peak asteroids  %zu\n", peakAsteroids);
+	std::printf("peak bullets    %zu\n", peakBullets);
+	std::printf("checksum        %016llx\n", world_checksum(world));
+#ifdef ASTEROID_PROFILE
+	std::printf("\nlast %d ticks\n%s", PROFILE_WINDOW, profiler.report().c_str());
+	if (tracer.write("asteroid_headless_trace.json"))
+	{
+		std::printf("trace           asteroid_headless_trace.json\n");
+	}
+#endif
+
+	return 0;
+}
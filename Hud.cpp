@@ -0,0 +1,133 @@
+#include "Hud.h"
+
+#include <climits>
+
+Hud::Hud()
+{
+	this->vertices.setPrimitiveType(Quads);
+	this->texture = nullptr;
+	this->characterSize = 0;
+	this->dirty = true;
+}
+
+// Bakes the printable ASCII glyphs of font at this size and style.
+void Hud::setFont(const Font &font, unsigned characterSize, const Color &color, bool bold)
+{
+	for (int i = 0; i < HUD_GLYPH_COUNT; i++)
+	{
+		const Glyph &glyph = font.getGlyph(HUD_FIRST_GLYPH + i, characterSize, bold);
+		this->glyphs[i].bounds = glyph.bounds;
+		this->glyphs[i].rect = glyph.textureRect;
+		this->glyphs[i].advance = glyph.advance;
+	}
+
+	// looked up after every glyph is in, as loading one can grow the page
+	this->texture = &font.getTexture(characterSize);
+	this->characterSize = characterSize;
+	this->color = color;
+	this->dirty = true;
+}
+
+// Adds a "label value" counter with its top left corner at (x, y) and returns
+// its id. label must outlive the HUD (a string literal).
+int Hud::addField(const char *label, float x, float y)
+{
+	Field field = { label, x, y, INT_MIN };
+	this->fields.push_back(field);
+	this->dirty = true;
+	return (int)this->fields.size() - 1;
+}
+
+void Hud::set(int field, int value)
+{
+	if (this->fields[field].value != value)
+	{
+		this->fields[field].value = value;
+		this->dirty = true;
+	}
+}
+
+// Appends quads for text with its top left corner at (x, y) and returns where
+// the next character would go. Characters outside printable ASCII are skipped.
+float Hud::addText(const char *text, float x, float y)
+{
+	float baseline = y + this->characterSize;
+	for (const char *c = text; *c; c++)
+	{
+		int index = (unsigned char)*c - HUD_FIRST_GLYPH;
+		if (index < 0 || index >= HUD_GLYPH_COUNT)
+		{
+			continue;
+		}
+
+		const GlyphQuad &glyph = this->glyphs[index];
+		float left = x + glyph.bounds.left;
+		float top = baseline + glyph.bounds.top;
+		float right = left + glyph.bounds.width;
+		float bottom = top + glyph.bounds.height;
+		float u0 = (float)glyph.rect.left;
+		float v0 = (float)glyph.rect.top;
+		float u1 = u0 + glyph.rect.width;
+		float v1 = v0 + glyph.rect.height;
+
+		this->vertices.append(Vertex(Vector2f(left, top), this->color, Vector2f(u0, v0)));
+		this->vertices.append(Vertex(Vector2f(right, top), this->color, Vector2f(u1, v0)));
+		this->vertices.append(Vertex(Vector2f(right, bottom), this->color, Vector2f(u1, v1)));
+		this->vertices.append(Vertex(Vector2f(left, bottom), this->color, Vector2f(u0, v1)));
+
+		x += glyph.advance;
+	}
+	return x;
+}
+
+void Hud::rebuild()
+{
+	this->vertices.clear();
+	for (size_t f = 0; f < this->fields.size(); f++)
+	{
+		const Field &field = this->fields[f];
+		float x = this->addText(field.label, field.x, field.y);
+
+		// digits are written backwards from the end of the buffer
+		char digits[16];
+		char *end = digits + sizeof(digits) - 1;
+		char *start = end;
+		*end = '\0';
+
+		long long value = field.value;
+		bool negative = value < 0;
+		if (negative)
+		{
+			value = -value;
+		}
+		do
+		{
+			*--start = (char)('0' + value % 10);
+			value /= 10;
+		} while (value > 0);
+		if (negative)
+		{
+			*--start = '-';
+		}
+
+		this->addText(start, x, field.y);
+	}
+	this->dirty = false;
+}
+
+void Hud::draw(RenderTarget &target)
+{
+	if (!this->texture)
+	{
+		return;
+	}
+	if (this->dirty)
+	{
+		this->rebuild();
+	}
+	target.draw(this->vertices, RenderStates(this->texture));
+}
+
+Hud::~Hud()
+{
+}
@@ -0,0 +1,54 @@
+#pragma once
+#include <SFML/Graphics.hpp>
+#include <cstddef>
+#include <vector>
+
+using namespace sf;
+
+// the glyphs baked: ' ' to '~'
+const int HUD_FIRST_GLYPH = 32;
+const int HUD_GLYPH_COUNT = 95;
+
+// The in-game counters ("Life: 3", "Score: 120", ...) drawn as one batch of
+// glyph quads. Every printable ASCII glyph is looked up in the font once, in
+// setFont(), so the font's texture page already holds them all; after that
+// the HUD only copies quads. The vertices are rebuilt only when a value
+// actually changes, and the rebuild formats numbers into a fixed buffer and
+// reuses the vertex memory, so a frame with unchanged values does no string
+// work and no allocation.
+class Hud
+{
+private:
+	struct GlyphQuad
+	{
+		FloatRect bounds;
+		IntRect rect;
+		float advance;
+	};
+
+	struct Field
+	{
+		const char *label;
+		float x, y;
+		int value;
+	};
+
+	GlyphQuad glyphs[HUD_GLYPH_COUNT];
+	const Texture *texture;
+	unsigned characterSize;
+	Color color;
+	std::vector<Field> fields;
+	VertexArray vertices;
+	bool dirty;
+
+	float addText(const char *, float, float);
+	void rebuild();
+
+public:
+	Hud();
+	void setFont(const Font &, unsigned, const Color &, bool);
+	int addField(const char *, float, float);
+	void set(int, int);
+	void draw(RenderTarget &);
+	~Hud();
+};
@@ -0,0 +1,31 @@
+#pragma once
+
+// Bits of Input::buttons. The values are also the bit order of recorded
+// sessions, so they must not change.
+enum InputButton
+{
+	ButtonUp = 1 << 0,          // W
+	ButtonDown = 1 << 1,        // S
+	ButtonLeft = 1 << 2,        // A
+	ButtonRight = 1 << 3,       // D
+	ButtonFire = 1 << 4,        // left mouse button
+	ButtonInvincible = 1 << 5,  // I
+	ButtonPause = 1 << 6,       // Escape
+	ButtonSkipLevel = 1 << 7    // P
+};
+
+// One tick of player input: which buttons are held, as a bitmask, and where
+// the player is aiming. The SFML front end builds it from window events; the
+// headless runner fills it from a bot or a recording. The simulation never
+// looks at a device directly.
+struct Input
+{
+	unsigned char buttons;
+	float aimX;  // mouse position in window coordinates
+	float aimY;
+
+	bool held(int button) const
+	{
+		return (this->buttons & button) != 0;
+	}
+};
@@ -0,0 +1,207 @@
+#include "InputRecording.h"
+
+#include <cstring>
+
+#include "FixedTimestep.h"
+#include "World.h"
+
+static const char MAGIC[4] = { 'A', 'S', 'I', 'R' };
+static const unsigned char VERSION = 1;
+
+// second byte of a tick entry
+static const unsigned char FLAG_AIM = 1;
+static const unsigned char FLAG_RESTART = 2;
+
+static void put_u32(FILE *file, unsigned value)
+{
+	unsigned char bytes[4] = { (unsigned char)value, (unsigned char)(value >> 8), (unsigned char)(value >> 16), (unsigned char)(value >> 24) };
+	std::fwrite(bytes, 1, 4, file);
+}
+
+static bool get_u32(FILE *file, unsigned &value)
+{
+	unsigned char bytes[4];
+	if (std::fread(bytes, 1, 4, file) != 4)
+	{
+		return false;
+	}
+	value = bytes[0] | bytes[1] << 8 | bytes[2] << 16 | (unsigned)bytes[3] << 24;
+	return true;
+}
+
+static void put_float(FILE *file, float value)
+{
+	unsigned bits;
+	std::memcpy(&bits, &value, 4);
+	put_u32(file, bits);
+}
+
+static bool get_float(FILE *file, float &value)
+{
+	unsigned bits;
+	if (!get_u32(file, bits))
+	{
+		return false;
+	}
+	std::memcpy(&value, &bits, 4);
+	return true;
+}
+
+InputRecorder::InputRecorder()
+{
+	this->file = nullptr;
+	this->lastAimX = 0;
+	this->lastAimY = 0;
+}
+
+// Starts a new recording at path. Returns false if it cannot be created.
+bool InputRecorder::open(const char *path, const RecordingHeader &header)
+{
+	this->close();
+	this->file = std::fopen(path, "wb");
+	if (!this->file)
+	{
+		return false;
+	}
+
+	std::fwrite(MAGIC, 1, 4, this->file);
+	std::fputc(VERSION, this->file);
+	put_u32(this->file, header.seed);
+	put_float(this->file, header.tickRate);
+	put_u32(this->file, (unsigned)header.asteroidsPerWave);
+
+	this->lastAimX = 0;
+	this->lastAimY = 0;
+	return true;
+}
+
+bool InputRecorder::isOpen() const
+{
+	return this->file != nullptr;
+}
+
+// Appends the input of one tick; restart says the world was restarted just
+// before it.
+void InputRecorder::write(const Input &input, bool restart)
+{
+	if (!this->file)
+	{
+		return;
+	}
+
+	bool aimMoved = input.aimX != this->lastAimX || input.aimY != this->lastAimY;
+	std::fputc(input.buttons, this->file);
+	std::fputc((aimMoved ? FLAG_AIM : 0) | (restart ? FLAG_RESTART : 0), this->file);
+	if (aimMoved)
+	{
+		put_float(this->file, input.aimX);
+		put_float(this->file, input.aimY);
+		this->lastAimX = input.aimX;
+		this->lastAimY = input.aimY;
+	}
+}
+
+void InputRecorder::close()
+{
+	if (this->file)
+	{
+		std::fclose(this->file);
+		this->file = nullptr;
+	}
+}
+
+InputRecorder::~InputRecorder()
+{
+	this->close();
+}
+
+InputReplay::InputReplay()
+{
+	this->file = nullptr;
+	this->lastAimX = 0;
+	this->lastAimY = 0;
+	this->header = RecordingHeader();
+}
+
+// Opens a recording and reads its header. Returns false if the file is
+// missing, is not a recording of this version or has a header no session
+// could have been recorded with.
+bool InputReplay::open(const char *path)
+{
+	this->close();
+	this->file = std::fopen(path, "rb");
+	if (!this->file)
+	{
+		return false;
+	}
+
+	char magic[4];
+	unsigned perWave;
+	bool valid = std::fread(magic, 1, 4, this->file) == 4 && std::memcmp(magic, MAGIC, 4) == 0
+		&& std::fgetc(this->file) == VERSION
+		&& get_u32(this->file, this->header.seed)
+		&& get_float(this->file, this->header.tickRate)
+		&& get_u32(this->file, perWave)
+		&& perWave <= (unsigned)MAX_ASTEROIDS_PER_WAVE && valid_wave_size((int)perWave)
+		&& valid_tick_rate(this->header.tickRate);
+	if (!valid)
+	{
+		this->close();
+		return false;
+	}
+
+	this->header.asteroidsPerWave = (int)perWave;
+	this->lastAimX = 0;
+	this->lastAimY = 0;
+	return true;
+}
+
+bool InputReplay::isOpen() const
+{
+	return this->file != nullptr;
+}
+
+// Reads the next tick. Returns false at the end of the recording.
+bool InputReplay::next(Input &input, bool &restart)
+{
+	if (!this->file)
+	{
+		return false;
+	}
+
+	int keys = std::fgetc(this->file);
+	int flags = std::fgetc(this->file);
+	if (keys == EOF || flags == EOF)
+	{
+		return false;
+	}
+
+	if (flags & FLAG_AIM)
+	{
+		if (!get_float(this->file, this->lastAimX) || !get_float(this->file, this->lastAimY))
+		{
+			return false;
+		}
+	}
+
+	input = Input();
+	input.buttons = (unsigned char)keys;
+	input.aimX = this->lastAimX;
+	input.aimY = this->lastAimY;
+	restart = (flags & FLAG_RESTART) != 0;
+	return true;
+}
+
+void InputReplay::close()
+{
+	if (this->file)
+	{
+		std::fclose(this->file);
+		this->file = nullptr;
+	}
+}
+
+InputReplay::~InputReplay()
+{
+	this->close();
+}
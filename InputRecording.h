@@ -0,0 +1,53 @@
+#pragma once
+#include <cstdio>
+
+#include "Input.h"
+
+// What a session needs besides its inputs to be played back exactly: the
+// simulation is deterministic given the World::seed() value, the tick length
+// and the wave size.
+struct RecordingHeader
+{
+	unsigned seed;
+	float tickRate;
+	int asteroidsPerWave;
+};
+
+// A recorded session is the header followed by one entry per simulation tick:
+// the Input::buttons byte, a byte of flags and, only when the aim moved since
+// the previous tick, the aim position as two raw floats. Holding still costs
+// two bytes a tick. Everything is little endian.
+//
+// The restart flag marks a tick that starts with World::restart(), which the
+// front end does outside the tick input (the death and pause screens).
+class InputRecorder
+{
+private:
+	FILE *file;
+	float lastAimX, lastAimY;
+
+public:
+	InputRecorder();
+	bool open(const char *, const RecordingHeader &);
+	bool isOpen() const;
+	void write(const Input &, bool);
+	void close();
+	~InputRecorder();
+};
+
+class InputReplay
+{
+private:
+	FILE *file;
+	float lastAimX, lastAimY;
+
+public:
+	RecordingHeader header;
+
+	InputReplay();
+	bool open(const char *);
+	bool isOpen() const;
+	bool next(Input &, bool &);
+	void close();
+	~InputReplay();
+};
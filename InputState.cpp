@@ -0,0 +1,96 @@
+#include "InputState.h"
+
+InputState::InputState()
+{
+	this->held = 0;
+	this->tapped = 0;
+	this->aimX = 0;
+	this->aimY = 0;
+}
+
+// The button a key drives, or 0.
+unsigned char InputState::keyButton(Keyboard::Key key)
+{
+	switch (key)
+	{
+	case Keyboard::W:
+		return ButtonUp;
+	case Keyboard::S:
+		return ButtonDown;
+	case Keyboard::A:
+		return ButtonLeft;
+	case Keyboard::D:
+		return ButtonRight;
+	case Keyboard::I:
+		return ButtonInvincible;
+	case Keyboard::Escape:
+		return ButtonPause;
+	case Keyboard::P:
+		return ButtonSkipLevel;
+	default:
+		return 0;
+	}
+}
+
+void InputState::feed(const Event &event)
+{
+	switch (event.type)
+	{
+	case Event::KeyPressed:
+		this->held |= keyButton(event.key.code);
+		this->tapped |= keyButton(event.key.code);
+		break;
+	case Event::KeyReleased:
+		this->held &= ~keyButton(event.key.code);
+		break;
+	case Event::MouseButtonPressed:
+		if (event.mouseButton.button == Mouse::Left)
+		{
+			this->held |= ButtonFire;
+			this->tapped |= ButtonFire;
+		}
+		this->aimX = (float)event.mouseButton.x;
+		this->aimY = (float)event.mouseButton.y;
+		break;
+	case Event::MouseButtonReleased:
+		if (event.mouseButton.button == Mouse::Left)
+		{
+			this->held &= ~ButtonFire;
+		}
+		break;
+	case Event::MouseMoved:
+		this->aimX = (float)event.mouseMove.x;
+		this->aimY = (float)event.mouseMove.y;
+		break;
+	case Event::LostFocus:
+		// releases that happen in another window never reach us
+		this->release();
+		break;
+	default:
+		break;
+	}
+}
+
+// The input for the coming tick: everything held now plus everything pressed
+// since the last snapshot.
+Input InputState::snapshot()
+{
+	Input input;
+	input.buttons = this->held | this->tapped;
+	input.aimX = this->aimX;
+	input.aimY = this->aimY;
+
+	this->tapped = 0;
+	return input;
+}
+
+// Lets go of every button.
+void InputState::release()
+{
+	this->held = 0;
+	this->tapped = 0;
+}
+
+InputState::~InputState()
+{
+}
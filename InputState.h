@@ -0,0 +1,29 @@
+#pragma once
+#include <SFML/Window.hpp>
+
+#include "Input.h"
+
+using namespace sf;
+
+// Builds the simulation's Input from window events instead of polling every
+// key each frame. feed() is handed every event pollEvent() returns and keeps
+// the held buttons as a bitmask; snapshot() reads it once per tick. A button
+// pressed and released between two snapshots shows up in the next one and
+// only that one, so a short tap is neither lost at low frame rates nor
+// repeated by the catch-up ticks of a slow frame.
+class InputState
+{
+private:
+	unsigned char held;
+	unsigned char tapped;
+	float aimX, aimY;
+
+	static unsigned char keyButton(Keyboard::Key);
+
+public:
+	InputState();
+	void feed(const Event &);
+	Input snapshot();
+	void release();
+	~InputState();
+};
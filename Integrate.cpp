@@ -0,0 +1,109 @@
+#include "Integrate.h"
+
+#ifdef SIMD_SSE2
+#include <emmintrin.h>
+#endif
+
+void integrate_wrap_scalar(const IntegrateArgs &a, size_t begin, size_t end)
+{
+	for (size_t i = begin; i < end; i++)
+	{
+		float x = a.x[i];
+		float y = a.y[i];
+		float r = a.radius[i];
+
+		bool top = y + r <= 0;
+		bool bottom = !top && y + r >= a.height;
+		bool left = !top && !bottom && x + r <= 0;
+		bool right = !top && !bottom && !left && x + r >= a.width;
+		bool wrapped = top || bottom || left || right;
+
+		float wrapX = left ? a.width - r - 1 : right ? -r + 1 : x;
+		float wrapY = top ? a.height - r - 1 : bottom ? -r + 1 : y;
+
+		float dx = a.dirX[i] * a.velocity[i] * a.dt;
+		float dy = a.dirY[i] * a.velocity[i] * a.dt;
+		if (wrapped && !a.moveOnWrap)
+		{
+			dx = 0;
+			dy = 0;
+		}
+
+		a.x[i] = wrapX + dx;
+		a.y[i] = wrapY + dy;
+	}
+}
+
+#ifdef SIMD_SSE2
+// mask ? a : b
+static inline __m128 select4(__m128 mask, __m128 a, __m128 b)
+{
+	return _mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, b));
+}
+
+void integrate_wrap_sse2(const IntegrateArgs &a, size_t begin, size_t end)
+{
+	const __m128 zero = _mm_setzero_ps();
+	const __m128 one = _mm_set1_ps(1.f);
+	const __m128 width = _mm_set1_ps(a.width);
+	const __m128 height = _mm_set1_ps(a.height);
+	const __m128 dt = _mm_set1_ps(a.dt);
+	const __m128 keepOnWrap = a.moveOnWrap ? _mm_castsi128_ps(_mm_set1_epi32(-1)) : zero;
+
+	size_t i = begin;
+	for (; i + 4 <= end; i += 4)
+	{
+		__m128 x = _mm_loadu_ps(a.x + i);
+		__m128 y = _mm_loadu_ps(a.y + i);
+		__m128 r = _mm_loadu_ps(a.radius + i);
+		__m128 xr = _mm_add_ps(x, r);
+		__m128 yr = _mm_add_ps(y, r);
+
+		__m128 top = _mm_cmple_ps(yr, zero);
+		__m128 bottom = _mm_andnot_ps(top, _mm_cmpge_ps(yr, height));
+		__m128 vertical = _mm_or_ps(top, bottom);
+		__m128 left = _mm_andnot_ps(vertical, _mm_cmple_ps(xr, zero));
+		__m128 right = _mm_andnot_ps(_mm_or_ps(vertical, left), _mm_cmpge_ps(xr, width));
+		__m128 wrapped = _mm_or_ps(vertical, _mm_or_ps(left, right));
+
+		__m128 nearEdge = _mm_add_ps(_mm_sub_ps(zero, r), one);
+		__m128 wrapX = select4(left, _mm_sub_ps(_mm_sub_ps(width, r), one), select4(right, nearEdge, x));
+		__m128 wrapY = select4(top, _mm_sub_ps(_mm_sub_ps(height, r), one), select4(bottom, nearEdge, y));
+
+		__m128 velocity = _mm_loadu_ps(a.velocity + i);
+		__m128 dx = _mm_mul_ps(_mm_mul_ps(_mm_loadu_ps(a.dirX + i), velocity), dt);
+		__m128 dy = _mm_mul_ps(_mm_mul_ps(_mm_loadu_ps(a.dirY + i), velocity), dt);
+		__m128 moving = _mm_or_ps(keepOnWrap, _mm_xor_ps(wrapped, _mm_castsi128_ps(_mm_set1_epi32(-1))));
+
+		_mm_storeu_ps(a.x + i, _mm_add_ps(wrapX, _mm_and_ps(moving, dx)));
+		_mm_storeu_ps(a.y + i, _mm_add_ps(wrapY, _mm_and_ps(moving, dy)));
+	}
+
+	integrate_wrap_scalar(a, i, end);
+}
+#else
+void integrate_wrap_sse2(const IntegrateArgs &a, size_t begin, size_t end)
+{
+	integrate_wrap_scalar(a, begin, end);
+}
+#endif
+
+IntegrateKernel integrate_kernel(int path)
+{
+	switch (path)
+	{
+	case SimdSSE2:
+		return integrate_wrap_sse2;
+	case SimdAVX2:
+		return integrate_wrap_avx2;
+	default:
+		return integrate_wrap_scalar;
+	}
+}
+
+void integrate_wrap(EntityStore &store, float dt, float width, float height, bool moveOnWrap)
+{
+	IntegrateArgs args = { store.x.data(), store.y.data(), store.dirX.data(), store.dirY.data(),
+		store.velocity.data(), store.radius.data(), dt, width, height, moveOnWrap };
+	integrate_kernel(simd_path())(args, store.head, store.size());
+}
@@ -0,0 +1,38 @@
+#pragma once
+#include <cstddef>
+
+#include "EntityStore.h"
+#include "SimdPath.h"
+
+// Moves entities along dirX/dirY * velocity and wraps them at the screen
+// edges, over the position columns of an EntityStore. The wrap test looks at
+// the position before the move and at most one edge is handled per tick, in
+// the order top, bottom, left, right (the rules update_state() always had).
+// With moveOnWrap the wrapped entity also moves this tick (asteroids);
+// without it it only jumps to the other edge (bullets).
+//
+// There is a scalar, an SSE2 and an AVX2 version. They give bit-identical
+// results; integrate_wrap() runs the one simd_path() selects.
+struct IntegrateArgs
+{
+	float *x;
+	float *y;
+	const float *dirX;
+	const float *dirY;
+	const float *velocity;
+	const float *radius;
+	float dt;
+	float width;
+	float height;
+	bool moveOnWrap;
+};
+
+typedef void (*IntegrateKernel)(const IntegrateArgs &, size_t, size_t);
+
+void integrate_wrap(EntityStore &, float, float, float, bool);
+
+// single versions, for benchmarks; each handles entities [begin, end)
+void integrate_wrap_scalar(const IntegrateArgs &, size_t, size_t);
+void integrate_wrap_sse2(const IntegrateArgs &, size_t, size_t);
+void integrate_wrap_avx2(const IntegrateArgs &, size_t, size_t);
+IntegrateKernel integrate_kernel(int);
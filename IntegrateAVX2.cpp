@@ -0,0 +1,65 @@
+// Built with AVX2 code generation enabled (see CMakeLists.txt). Nothing in
+// here runs unless simd_path_supported() saw AVX2 on the CPU.
+#include "Integrate.h"
+
+#ifdef __AVX2__
+#include <immintrin.h>
+
+// read by SimdPath.cpp; NarrowPhaseAVX2.cpp is built with the same flags
+extern const bool simdAvx2Built = true;
+
+// mask ? a : b
+static inline __m256 select8(__m256 mask, __m256 a, __m256 b)
+{
+	return _mm256_blendv_ps(b, a, mask);
+}
+
+void integrate_wrap_avx2(const IntegrateArgs &a, size_t begin, size_t end)
+{
+	const __m256 zero = _mm256_setzero_ps();
+	const __m256 one = _mm256_set1_ps(1.f);
+	const __m256 allSet = _mm256_castsi256_ps(_mm256_set1_epi32(-1));
+	const __m256 width = _mm256_set1_ps(a.width);
+	const __m256 height = _mm256_set1_ps(a.height);
+	const __m256 dt = _mm256_set1_ps(a.dt);
+	const __m256 keepOnWrap = a.moveOnWrap ? allSet : zero;
+
+	size_t i = begin;
+	for (; i + 8 <= end; i += 8)
+	{
+		__m256 x = _mm256_loadu_ps(a.x + i);
+		__m256 y = _mm256_loadu_ps(a.y + i);
+		__m256 r = _mm256_loadu_ps(a.radius + i);
+		__m256 xr = _mm256_add_ps(x, r);
+		__m256 yr = _mm256_add_ps(y, r);
+
+		__m256 top = _mm256_cmp_ps(yr, zero, _CMP_LE_OS);
+		__m256 bottom = _mm256_andnot_ps(top, _mm256_cmp_ps(yr, height, _CMP_GE_OS));
+		__m256 vertical = _mm256_or_ps(top, bottom);
+		__m256 left = _mm256_andnot_ps(vertical, _mm256_cmp_ps(xr, zero, _CMP_LE_OS));
+		__m256 right = _mm256_andnot_ps(_mm256_or_ps(vertical, left), _mm256_cmp_ps(xr, width, _CMP_GE_OS));
+		__m256 wrapped = _mm256_or_ps(vertical, _mm256_or_ps(left, right));
+
+		__m256 nearEdge = _mm256_add_ps(_mm256_sub_ps(zero, r), one);
+		__m256 wrapX = select8(left, _mm256_sub_ps(_mm256_sub_ps(width, r), one), select8(right, nearEdge, x));
+		__m256 wrapY = select8(top, _mm256_sub_ps(_mm256_sub_ps(height, r), one), select8(bottom, nearEdge, y));
+
+		__m256 velocity = _mm256_loadu_ps(a.velocity + i);
+		__m256 dx = _mm256_mul_ps(_mm256_mul_ps(_mm256_loadu_ps(a.dirX + i), velocity), dt);
+		__m256 dy = _mm256_mul_ps(_mm256_mul_ps(_mm256_loadu_ps(a.dirY + i), velocity), dt);
+		__m256 moving = _mm256_or_ps(keepOnWrap, _mm256_xor_ps(wrapped, allSet));
+
+		_mm256_storeu_ps(a.x + i, _mm256_add_ps(wrapX, _mm256_and_ps(moving, dx)));
+		_mm256_storeu_ps(a.y + i, _mm256_add_ps(wrapY, _mm256_and_ps(moving, dy)));
+	}
+
+	integrate_wrap_sse2(a, i, end);
+}
+#else
+extern const bool simdAvx2Built = false;
+
+void integrate_wrap_avx2(const IntegrateArgs &a, size_t begin, size_t end)
+{
+	integrate_wrap_sse2(a, begin, end);
+}
+#endif
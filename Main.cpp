@@ -6,157 +6,253 @@
 #include <SFML/OpenGL.hpp>
 #include <SFML/Main.hpp>
 
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
 #include <ctime>
 #include <vector>
-#include <memory>
 
+#include "AnimationPool.h"
+#include "AssetManager.h"
+#include "AssetPack.h"
+#include "BatchRenderer.h"
+#include "FixedTimestep.h"
+#include "Hud.h"
+#include "InputRecording.h"
+#include "InputState.h"
+#include "Profiler.h"
+#include "Random.h"
+#include "SoundPool.h"
 #include "SpaceShip.h"
-#include "Bullet.h"
-#include "Asteroid.h"
+#include "TraceRecorder.h"
+#include "TextureAtlas.h"
+#include "World.h"
 
 using namespace sf;
 
 int GameState = 0;
 bool isPaused = false;
 
-const int GAMEWIDTH = 2880;
-const int GAMEHEIGHT = 1800;
-
-const float PI = 3.1415926;
-
-Vector2f bulletSize(150, 30);
-float bulletVelocity = 500.f;
-
-float shipRadius = 55.f;
-float bulletRadius = 15.f;
-
-String shiptDirState;
-SpaceShip ship(shipRadius);
-float shipVelocity = 500.f;
-float tempShipVelocity = 0.f;
-float speedInterval = 4.f;
-
-std::vector<std::unique_ptr<Asteroid>> manyAsteroids;
-std::vector<std::unique_ptr<Bullet>> manyBullets;
-std::vector<Asteroid *> asteroidsAdded;
-std::vector<std::vector<std::unique_ptr<Asteroid>>> grid;
-
-float astroidVelocity = 250.f;
-float sAstRadius = 35.f;
-float mAstRadius = 55.f;
-float bAstRadius = 85.f;
-
-int score = 0, life = 3, level = 1;
-int flashTimer = 100;
+World world;
+FixedTimestep timestep(DEFAULT_TICK_RATE, DEFAULT_MAX_CATCHUP_TICKS);
+SpaceShip ship(world.shipRadius);
 Color shellColor(239, 244, 248, 50);
 
 RenderWindow window(VideoMode(GAMEWIDTH, GAMEHEIGHT), "Max's Asteroid!");
-Text lifeTxt, scoreTxt, restartTxt, menutext, levelText;
-Texture texture, pushTexture, astTexture, bulletTexture, explosion;
+Text restartTxt, menutext, pauseTxt, profileTxt;
+// life, score and level; redrawn only when they change
+Hud hud;
+int hudLife, hudScore, hudLevel;
+// the score restartTxt was last laid out for
+int restartScore = -1;
+// F3 shows the profiler overlay and F4 writes the trace; both only have
+// numbers in ASTEROID_PROFILE builds
+bool showProfile = false;
+const char *tracePath = "trace.json";
+bool traceAtExit = false;
+Texture texture;
 Sprite background, shipPush;
-Texture shipSprite;
-SoundBuffer buf1, buf2, buf3, buf4, buf5;
-Sound shootSound, driftSound, explodeSound, crashSound, winSound;
+// every sprite except the background lives in one atlas, so the whole entity
+// layer is a single batch
+TextureAtlas atlas;
+int shipRegion, pushRegion, astRegion, fireballRegion, explosionRegion;
+const int EXPLOSION_FRAMES = 64;
+BatchRenderer spriteBatch;
+// assets.pak is mapped once and read in place; anything missing from it, or
+// damaged, is loaded from the loose file. Declared before everything that
+// reads from the mapping so it is unmapped last.
+AssetPack pack;
+// checksum every pack entry as it is loaded; always on in debug builds
+#ifdef NDEBUG
+bool verifyAssets = false;
+#else
+bool verifyAssets = true;
+#endif
+// images and sounds decode on worker threads while a progress bar shows
+AssetManager assets;
+int backgroundAsset, shipAsset, pushAsset, astAsset, fireballAsset, explosionAsset;
+int shootAsset, driftAsset, explodeAsset, crashAsset, winAsset;
+// every sound effect plays through the pool, so a busy frame still starts
+// only a few voices
+SoundPool sounds;
+int shootEffect, driftEffect, explodeEffect, crashEffect, winEffect;
 Music backgroundMusic;
 
-bool isInvincible = true;
-int invincibleTime = 10;
-
-void setControl(float);
-void render_frame();
+void play_events();
+void update_effects();
+void update_hud();
+void render_frame(float);
+void draw_frame(float);
 void render_menu();
 void render_pause();
-void update_state(float);
-void shoot();
-void create_ast();
 void render_death();
-void ast_get_hit(Asteroid *, int);
-void make_it_invincible();
-int checkGrid(Vector2f);
-void collision_check(CircleShape *, CircleShape *);
-bool is_collided(CircleShape *, CircleShape *);
-void ast_bounce(Asteroid *, Asteroid *);
-void ck_optimize();
 void restart();
-void respawn();
-void levelUp();
-
-class Animation
+bool load_assets(const Font &);
+void upload_asset(int);
+void play_replay(float);
+
+// explosions reuse one clip; the pool never grows past MAX_EXPLOSIONS
+const size_t MAX_EXPLOSIONS = 256;
+AnimationPool explosions(MAX_EXPLOSIONS);
+int explosionClip;
+
+// --record saves every tick's input; --replay plays a recording back instead
+// of reading the keyboard, in real time or, with --fast, one tick per frame
+InputRecorder recorder;
+InputReplay replay;
+bool replayFast = false;
+// set by restart(); the next recorded tick carries it
+bool restartPending = false;
+// the player's buttons and aim, kept up to date from window events
+InputState inputState;
+// for cosmetic variety only; the simulation has its own streams
+Random effectsRandom;
+
+// usage: Asteroids [--tick-rate HZ] [--record FILE | --replay FILE [--fast]] [--profile-csv FILE] [--trace FILE] [--verify-assets]
+int main(int argc, char **argv)
 {
-public:
-	float Frame, speed;
-	Sprite sprite;
-	std::vector<IntRect> frames;
-
-	Animation() {}
-
-	Animation(Texture &t, int x, int y, int w, int h, int count, float Speed)
+	Clock startupClock;
+	float tickRate = DEFAULT_TICK_RATE;
+	const char *recordPath = nullptr;
+	const char *replayPath = nullptr;
+	for (int i = 1; i < argc; i++)
 	{
-		Frame = 0;
-		speed = Speed;
-
-		for (int i = 0; i<count; i++)
-			frames.push_back(IntRect(x + i*w, y, w, h));
-
-		sprite.setTexture(t);
-		sprite.setOrigin(w / 2, h / 2);
-		sprite.setTextureRect(frames[0]);
+		if (std::strcmp(argv[i], "--fast") == 0)
+		{
+			replayFast = true;
+		}
+		else if (std::strcmp(argv[i], "--verify-assets") == 0)
+		{
+			verifyAssets = true;
+		}
+		else if (i + 1 == argc)
+		{
+			break;
+		}
+		else if (std::strcmp(argv[i], "--tick-rate") == 0)
+		{
+			tickRate = std::atof(argv[++i]);
+		}
+		else if (std::strcmp(argv[i], "--record") == 0)
+		{
+			recordPath = argv[++i];
+		}
+		else if (std::strcmp(argv[i], "--replay") == 0)
+		{
+			replayPath = argv[++i];
+		}
+		else if (std::strcmp(argv[i], "--profile-csv") == 0)
+		{
+#ifdef ASTEROID_PROFILE
+			profiler.openCsv(argv[++i]);
+#else
+			std::fprintf(stderr, "--profile-csv ignored: profiler not built in (configure with -DASTEROID_PROFILE=ON)\n");
+			i++;
+#endif
+		}
+		else if (std::strcmp(argv[i], "--trace") == 0)
+		{
+			tracePath = argv[++i];
+			traceAtExit = true;
+		}
 	}
 
-
-	void update()
+	unsigned seed = (unsigned)std::time(0);
+	if (replayPath && !replay.open(replayPath))
 	{
-		Frame += speed;
-		int n = frames.size();
-		if (Frame >= n) Frame -= n;
-		if (n>0) sprite.setTextureRect(frames[int(Frame)]);
+		std::fprintf(stderr, "cannot read recording %s\n", replayPath);
+		return 1;
 	}
-
-	bool isEnd()
+	if (replay.isOpen())
 	{
-		return Frame + speed >= frames.size();
+		seed = replay.header.seed;
+		tickRate = replay.header.tickRate;
+		world.asteroidsPerWave = replay.header.asteroidsPerWave;
+		GameState = 1;
 	}
+	if (!valid_tick_rate(tickRate))
+	{
+		std::fprintf(stderr, "tick rate must be a positive number of ticks per second, not %g\n", tickRate);
+		return 1;
+	}
+	if (recordPath && !replay.isOpen())
+	{
+		RecordingHeader header = { seed, tickRate, world.asteroidsPerWave };
+		if (!recorder.open(recordPath, header))
+		{
+			std::fprintf(stderr, "cannot write recording %s\n", recordPath);
+			return 1;
+		}
+	}
+	timestep.setRate(tickRate);
+	world.seed(seed);
+	effectsRandom.seed(seed, RandomEffects);
 
-};
-
-std::vector<Animation *> allExplosion;
-
-int main()
-{
-	std::srand(std::time(0));
+	pack.open("assets.pak");
+	pack.setChecking(verifyAssets);
+	assets.setPack(&pack);
+	backgroundAsset = assets.addImage("background.jpg");
+	shipAsset = assets.addImage("ship.png");
+	pushAsset = assets.addImage("shipPush.png");
+	astAsset = assets.addImage("Asteroid.png");
+	fireballAsset = assets.addImage("Fireball.png");
+	explosionAsset = assets.addImage("explosion.png");
+	shootAsset = assets.addSound("shoot.wav");
+	driftAsset = assets.addSound("drifting.wav");
+	explodeAsset = assets.addSound("explode.wav");
+	crashAsset = assets.addSound("crash.wav");
+	winAsset = assets.addSound("win.wav");
+	assets.start(0);
 
+	// the font is needed for the loading screen itself
 	Font font;
+	const void *data;
+	size_t size;
+	bool fontLoaded = pack.lookup("arial.ttf", data, size) ? font.loadFromMemory(data, size) : font.loadFromFile("arial.ttf");
+	if (!fontLoaded)
+	{
+		std::fprintf(stderr, "cannot load arial.ttf\n");
+	}
 
-	font.loadFromFile("arial.TTF");
-	texture.loadFromFile("background.jpg");
-
-	pushTexture.loadFromFile("shipPush.png");
-	shipPush.setTexture(pushTexture);
+	if (!load_assets(font))
+	{
+		return 0;
+	}
+	// a missing image leaves its atlas region unset, which the drawing code
+	// would index with
+	for (int i = 0; i < assets.getCount(); i++)
+	{
+		if (!assets.isLoaded(i))
+		{
+			std::fprintf(stderr, "cannot load %s\n", assets.getPath(i).c_str());
+			return 1;
+		}
+	}
+	if (!atlas.build(4096))
+	{
+		std::fprintf(stderr, "sprite atlas does not fit the GPU's texture size\n");
+		return 1;
+	}
+	explosionClip = explosions.addClip(explosionRegion, EXPLOSION_FRAMES, 0.6f);
 
-	astTexture.loadFromFile("Asteroid.png");
-	bulletTexture.loadFromFile("Fireball.png");
-	explosion.loadFromFile("explosion.png");
+	shipPush.setTexture(atlas.getTexture());
+	shipPush.setTextureRect(atlas.getRegion(pushRegion));
+	shipPush.setOrigin(Vector2f(35, 10));
 
 	background.setScale(Vector2f(1.5, 1.5));
 	background.setTexture(texture);
 	
-	lifeTxt.setFont(font);
-	lifeTxt.setCharacterSize(50);
-	lifeTxt.setFillColor(sf::Color::Red);
-	lifeTxt.setStyle(Text::Bold);
-	lifeTxt.setPosition(20, GAMEHEIGHT - 80);
-
-	levelText.setFont(font);
-	levelText.setCharacterSize(50);
-	levelText.setFillColor(sf::Color::Red);
-	levelText.setStyle(Text::Bold);
-	levelText.setPosition(20, 80);
-
-	scoreTxt.setFont(font);
-	scoreTxt.setCharacterSize(50);
-	scoreTxt.setFillColor(sf::Color::Red);
-	scoreTxt.setStyle(Text::Bold);
-	scoreTxt.setPosition(GAMEWIDTH - 250, GAMEHEIGHT - 80);
+	hud.setFont(font, 50, sf::Color::Red, true);
+	hudLife = hud.addField("Life: ", 20, GAMEHEIGHT - 80);
+	hudLevel = hud.addField("Level: ", 20, 80);
+	hudScore = hud.addField("Score: ", GAMEWIDTH - 250, GAMEHEIGHT - 80);
+	update_hud();
+
+	profileTxt.setFont(font);
+	profileTxt.setCharacterSize(24);
+	profileTxt.setFillColor(sf::Color::Yellow);
+	profileTxt.setPosition(20, 20);
 
 	restartTxt.setFont(font);
 	restartTxt.setCharacterSize(50);
@@ -169,43 +265,63 @@ int main()
 	menutext.setFillColor(sf::Color::Red);
 	menutext.setStyle(Text::Bold);
 	menutext.setPosition(GAMEWIDTH / 3.5, GAMEHEIGHT / 2 - 50);
+	menutext.setString("Welcome, press \"Enter\" to start, or press \"P\" to exit");
 
-	ship.setPosition(Vector2f(GAMEWIDTH/2, GAMEHEIGHT /2 ));
-	ship.setOrigin(Vector2f(shipRadius, shipRadius));
-	shipSprite.loadFromFile("ship.png");
-	ship.setTexture(&shipSprite);
+	// the menu texts never change, so each is laid out once
+	pauseTxt = menutext;
+	pauseTxt.setString("Press \"Enter\" to re-start, \"r\" to resume, or press \"P\" to exit");
 
-	buf1.loadFromFile("shoot.wav");
-	buf2.loadFromFile("drifting.wav");
-	buf3.loadFromFile("explode.wav");
-	buf4.loadFromFile("crash.wav");
-	buf5.loadFromFile("win.wav");
+	ship.setOrigin(Vector2f(world.shipRadius, world.shipRadius));
+	ship.setTexture(&atlas.getTexture());
+	ship.setTextureRect(atlas.getRegion(shipRegion));
 
-	shootSound.setBuffer(buf1);
-	driftSound.setBuffer(buf2);
-	explodeSound.setBuffer(buf3);
-	crashSound.setBuffer(buf4);
-	winSound.setBuffer(buf5);
+	// voices, minimum seconds between starts, priority
+	shootEffect = sounds.addEffect(assets.getSound(shootAsset), 3, 0.06f, 1);
+	driftEffect = sounds.addEffect(assets.getSound(driftAsset), 1, 0.f, 0);
+	explodeEffect = sounds.addEffect(assets.getSound(explodeAsset), 4, 0.03f, 2);
+	crashEffect = sounds.addEffect(assets.getSound(crashAsset), 1, 0.f, 3);
+	winEffect = sounds.addEffect(assets.getSound(winAsset), 1, 0.f, 3);
 
-	backgroundMusic.openFromFile("background.flac");
+	// streamed, so opening it only reads the header
+	bool musicOpened = pack.lookup("background.flac", data, size) ? backgroundMusic.openFromMemory(data, size) : backgroundMusic.openFromFile("background.flac");
+	if (!musicOpened)
+	{
+		std::fprintf(stderr, "cannot open background.flac\n");
+	}
 	backgroundMusic.setVolume(30);
 	backgroundMusic.play();
 	backgroundMusic.setLoop(true);
+	std::printf("startup took %.2f ms\n", startupClock.getElapsedTime().asMicroseconds() / 1000.0);
 
-	Clock clock, countClock;
+	Clock clock;
 
-	create_ast();
+	world.restart();
 
 	while (window.isOpen())
 	{
+		TRACE_SCOPE("frame");
+
 		Event event;
 		while (window.pollEvent(event))
 		{
 			if (event.type == Event::Closed)
 				window.close();
+			else if (event.type == Event::KeyPressed && event.key.code == Keyboard::F3)
+				showProfile = !showProfile;
+			else if (event.type == Event::KeyPressed && event.key.code == Keyboard::F4)
+				tracer.write(tracePath);
+
+			inputState.feed(event);
+		}
+
+		// keys tapped on the menu, pause and game over screens are not meant
+		// for the ship
+		if (GameState != 1 || isPaused)
+		{
+			inputState.snapshot();
 		}
 
-		float dt = clock.restart().asSeconds();
+		float frameTime = clock.restart().asSeconds();
 
 		switch (GameState)
 		{
@@ -213,15 +329,53 @@ int main()
 			render_menu();
 			break;
 		case 1:
-			if (isPaused)
+			if (replay.isOpen())
+			{
+				play_replay(frameTime);
+			}
+			else if (isPaused)
 			{
 				render_pause();
 			}
 			else
 			{
-				setControl(dt);
-				update_state(dt);
-				render_frame();
+				// the simulation runs in fixed ticks; rendering blends between the last two
+				int ticks = timestep.advance(frameTime);
+				for (int t = 0; t < ticks && GameState == 1; t++)
+				{
+					// a snapshot per tick, so a tap reaches one tick only and
+					// waits for the next frame if this one runs none
+					Input input;
+					{
+						TRACE_SCOPE("input");
+						input = inputState.snapshot();
+					}
+					if (input.held(ButtonPause))
+					{
+						isPaused = true;
+						sounds.setLooping(driftEffect, false);
+					}
+
+					recorder.write(input, restartPending);
+					restartPending = false;
+					{
+						TRACE_SCOPE("update");
+						world.step(input, timestep.getTickLength());
+					}
+					play_events();
+					update_effects();
+
+					if (world.life <= 0)
+					{
+						GameState = 3;
+						sounds.setLooping(driftEffect, false);
+					}
+				}
+
+				render_frame(timestep.alpha());
+#ifdef ASTEROID_PROFILE
+				profiler.endFrame();
+#endif
 			}
 			break;
 		case 2:
@@ -233,15 +387,119 @@ int main()
 		default:
 			break;
 		}
+
+		// starts what this frame's ticks asked for
+		sounds.update(frameTime);
+	}
+
+	if (traceAtExit)
+	{
+		tracer.write(tracePath);
 	}
 	return 0;
 }
 
+// Draws a progress bar until every asset has decoded, uploading each image
+// as soon as it is ready, then prints how long each file took. Returns false
+// if the window was closed meanwhile.
+bool load_assets(const Font &font)
+{
+	Text loadingTxt;
+	loadingTxt.setFont(font);
+	loadingTxt.setCharacterSize(50);
+	loadingTxt.setFillColor(sf::Color::Red);
+	loadingTxt.setStyle(Text::Bold);
+	loadingTxt.setPosition(GAMEWIDTH / 2 - 200, GAMEHEIGHT / 2 - 120);
+
+	RectangleShape frame(Vector2f(GAMEWIDTH / 2, 40));
+	frame.setPosition(GAMEWIDTH / 4, GAMEHEIGHT / 2);
+	frame.setFillColor(sf::Color::Transparent);
+	frame.setOutlineColor(sf::Color::Red);
+	frame.setOutlineThickness(4);
+
+	RectangleShape bar;
+	bar.setPosition(GAMEWIDTH / 4, GAMEHEIGHT / 2);
+	bar.setFillColor(sf::Color::Red);
+
+	int uploaded = 0;
+	while (uploaded < assets.getCount())
+	{
+		Event event;
+		while (window.pollEvent(event))
+		{
+			if (event.type == Event::Closed)
+			{
+				window.close();
+				return false;
+			}
+		}
+
+		int index;
+		while (assets.takeFinished(index))
+		{
+			upload_asset(index);
+			uploaded++;
+		}
+
+		float done = (float)uploaded / assets.getCount();
+		bar.setSize(Vector2f(GAMEWIDTH / 2 * done, 40));
+		loadingTxt.setString("Loading " + std::to_string(uploaded) + " / " + std::to_string(assets.getCount()));
+
+		window.clear();
+		window.draw(frame);
+		window.draw(bar);
+		window.draw(loadingTxt);
+		window.display();
+	}
+
+	assets.wait();
+	assets.report(stdout);
+	return true;
+}
+
+// GL-side work for one decoded asset. Runs on the main thread, which owns the
+// GL context; sound buffers need nothing more.
+void upload_asset(int index)
+{
+	if (!assets.isLoaded(index) || assets.getType(index) != AssetImage)
+	{
+		return;
+	}
+
+	const Image &image = assets.getImage(index);
+	if (index == backgroundAsset)
+	{
+		texture.loadFromImage(image);
+	}
+	else if (index == shipAsset)
+	{
+		shipRegion = atlas.add(image);
+	}
+	else if (index == pushAsset)
+	{
+		pushRegion = atlas.add(image);
+	}
+	else if (index == astAsset)
+	{
+		astRegion = atlas.add(image);
+	}
+	else if (index == fireballAsset)
+	{
+		fireballRegion = atlas.add(image);
+	}
+	else if (index == explosionAsset)
+	{
+		// the explosion strip is one 64-frame row, too wide for many GPUs; the
+		// atlas repacks the frames onto shelves
+		explosionRegion = atlas.addFrames(image, 192, 192, EXPLOSION_FRAMES);
+	}
+	assets.releaseImage(index);
+}
+
 void render_menu()
 {
 	window.clear();
 
-	menutext.setString("Welcome, press \"Enter\" to start, or press \"P\" to exit");
 	if (Keyboard::isKeyPressed(Keyboard::Return))
 	{
 		GameState = 1;
@@ -259,7 +517,6 @@ void render_pause()
 {
 	window.clear();
 
-	menutext.setString("Press \"Enter\" to re-start, \"r\" to resume, or press \"P\" to exit");
 	if (Keyboard::isKeyPressed(Keyboard::Return))
 	{
 		isPaused = false;
@@ -274,14 +531,18 @@ void render_pause()
 		GameState = 2;
 	}
 
-	window.draw(menutext);
+	window.draw(pauseTxt);
 	window.display();
 }
 
 void render_death()
 {
 	window.clear();
-	restartTxt.setString("You scored " + std::to_string(score) + " points, press \"Enter\" to restart, or \"ESC\" to exit.");
+	if (world.score != restartScore)
+	{
+		restartScore = world.score;
+		restartTxt.setString("You scored " + std::to_string(world.score) + " points, press \"Enter\" to restart, or \"ESC\" to exit.");
+	}
 	window.draw(restartTxt);
 	window.display();
 
@@ -295,731 +556,189 @@ void render_death()
 	}
 }
 
-void render_frame()
+// Position between the previous and the current tick. Something that wrapped
+// around the screen edge during the tick is drawn where it is now.
+float lerp_wrapped(float previous, float current, float alpha, float span)
 {
-	window.clear();
-	window.draw(background);
-
-	if (tempShipVelocity == shipVelocity)
-	{
-		window.draw(shipPush);
-	}
-
-	window.draw(ship);
-	for (size_t i = 0; i < manyBullets.size(); ++i)
-	{
-		window.draw(*manyBullets[i]);
-	}
-	for (size_t i = 0; i < manyAsteroids.size(); i++)
+	if (std::fabs(current - previous) > span / 2)
 	{
-		window.draw(*manyAsteroids[i]);
+		return current;
 	}
+	return previous + (current - previous) * alpha;
+}
 
-	for (size_t i = 0; i < allExplosion.size(); i++)
+void render_frame(float alpha)
+{
 	{
-		window.draw(allExplosion[i]->sprite);
+		PROFILE_SCOPE(ProfileRender);
+		TRACE_SCOPE("render");
+		draw_frame(alpha);
 	}
 
-	window.draw(lifeTxt);
-	window.draw(scoreTxt);
-	window.draw(levelText);
-
+	PROFILE_SCOPE(ProfileDisplay);
+	TRACE_SCOPE("present");
 	window.display();
 }
 
-void update_state(float dt)
+void draw_frame(float alpha)
 {
-	if (Keyboard::isKeyPressed(Keyboard::I))
-	{
-		make_it_invincible();
-	}
-
-	if (Keyboard::isKeyPressed(Keyboard::Escape))
-	{
-		isPaused = true;
-	}
+	window.clear();
+	window.draw(background);
 
-	lifeTxt.setString("Life: " + std::to_string(life));
-	scoreTxt.setString("Score: " + std::to_string(score));
-	levelText.setString("Level: " + std::to_string(level));
+	float shipX = lerp_wrapped(world.ship.prevX, world.ship.x, alpha, GAMEWIDTH);
+	float shipY = lerp_wrapped(world.ship.prevY, world.ship.y, alpha, GAMEHEIGHT);
+	float shipRadius = world.shipRadius;
+	float aaa = world.ship.rotation * PI / 180;
 
-	if (life <= 0)
+	ship.setPosition(shipX, shipY);
+	ship.setRotation(world.ship.rotation);
+	if (world.ship.shielded)
 	{
-		GameState = 3;
+		ship.setFillColor(shellColor);
 	}
 
-	if (Keyboard::isKeyPressed(Keyboard::P))
+	if (world.ship.driftVelocity == world.shipVelocity)
 	{
-		ship.setPosition(Vector2f(GAMEWIDTH / 2, GAMEHEIGHT / 2));
-		astroidVelocity += 100;
-		manyAsteroids.clear();
-		manyBullets.clear();
-		create_ast();
+		shipPush.setPosition(Vector2f(shipX - shipRadius * sin(aaa), shipY + shipRadius * cos(aaa)));
+		shipPush.setRotation(world.ship.rotation);
+		window.draw(shipPush);
 	}
 
-	float shipX = ship.getPosition().x;
-	float shipY = ship.getPosition().y;
-	Vector2f curPos = ship.getPosition();
-	Vector2i mousePos = Mouse::getPosition(window);
+	window.draw(ship);
 
-	// flip ship
-	if (shipY + shipRadius <= 0 && Keyboard::isKeyPressed(Keyboard::W))
-	{
-		ship.setPosition(Vector2f(shipX, GAMEHEIGHT - shipRadius));
-	}
-	else if (shipY + shipRadius >= GAMEHEIGHT && Keyboard::isKeyPressed(Keyboard::S))
-	{
-		ship.setPosition(Vector2f(shipX, -shipRadius));
-	}
-	else if (shipX + shipRadius <= 0 && Keyboard::isKeyPressed(Keyboard::A))
-	{
-		ship.setPosition(Vector2f(GAMEWIDTH - shipRadius, shipY));
-	}
-	else if (shipX + shipRadius >= GAMEWIDTH && Keyboard::isKeyPressed(Keyboard::D))
-	{
-		ship.setPosition(Vector2f(-shipRadius, shipY));
-	}
-	
-	float rotation = atan2(mousePos.y - curPos.y, mousePos.x - curPos.x) * 180 / PI;
-	
-	float aaa = (rotation + 90) * PI / 180;
-	ship.setRotation(rotation + 90);
-	shipPush.setOrigin(Vector2f(35, 10));
-	shipPush.setPosition(Vector2f(shipX - shipRadius * sin(aaa), shipY + shipRadius * cos(aaa)));
-	shipPush.setRotation(rotation + 90);
+	// bullets, asteroids and explosions in one draw call, in that order
+	spriteBatch.begin(atlas.getTexture());
 
-	// bullets path
-	for (int i = manyBullets.size() - 1; i >= 0 ; i--)
+	const EntityStore &bullets = world.bullets;
+	const IntRect &fireball = atlas.getRegion(fireballRegion);
+	for (size_t i = bullets.head; i < bullets.size(); ++i)
 	{
-		float bulletX = manyBullets[i]->getPosition().x;
-		float bulletY = manyBullets[i]->getPosition().y;
-
-		if (manyBullets[i]->isDead(dt))
-		{
-			manyBullets.erase(manyBullets.begin() + i);
-			continue;
-		}
-		manyBullets[i]->moveBullet(dt);
-
-		if (bulletY + bulletRadius <= 0)
-		{
-			manyBullets[i]->setPosition(Vector2f(bulletX, GAMEHEIGHT - bulletRadius - 1));
-		}
-		else if (bulletY + bulletRadius >= GAMEHEIGHT)
-		{
-			manyBullets[i]->setPosition(Vector2f(bulletX, -bulletRadius + 1));
-		}
-		else if (bulletX + bulletRadius <= 0)
-		{
-			manyBullets[i]->setPosition(Vector2f(GAMEWIDTH - bulletRadius - 1, bulletY));
-		}
-		else if (bulletX + bulletRadius >= GAMEWIDTH)
-		{
-			manyBullets[i]->setPosition(Vector2f(-bulletRadius + 1, bulletY));
-		}
+		spriteBatch.add(lerp_wrapped(bullets.prevX[i], bullets.x[i], alpha, GAMEWIDTH),
+			lerp_wrapped(bullets.prevY[i], bullets.y[i], alpha, GAMEHEIGHT),
+			bullets.radius[i], bullets.radius[i], fireball);
 	}
 
-	// astroid path
-	for (int i = 0; i < manyAsteroids.size(); i++)
+	const EntityStore &asteroids = world.asteroids;
+	const IntRect &rock = atlas.getRegion(astRegion);
+	for (size_t i = 0; i < asteroids.size(); i++)
 	{
-		float astX = manyAsteroids[i]->getPosition().x;
-		float astY = manyAsteroids[i]->getPosition().y;
-		float astRadius = manyAsteroids[i]->getRadius();
-
-		if (astY + astRadius <= 0)
-		{
-			manyAsteroids[i]->setPosition(Vector2f(astX, GAMEHEIGHT - astRadius - 1));
-		}
-		else if (astY + astRadius >= GAMEHEIGHT)
-		{
-			manyAsteroids[i]->setPosition(Vector2f(astX, -astRadius + 1));
-		}
-		else if (astX + astRadius <= 0)
-		{
-			manyAsteroids[i]->setPosition(Vector2f(GAMEWIDTH - astRadius - 1, astY));
-		}
-		else if (astX + astRadius >= GAMEWIDTH)
-		{
-			manyAsteroids[i]->setPosition(Vector2f(-astRadius + 1, astY));
-		}
-		manyAsteroids[i]->moveAst(dt);
+		spriteBatch.add(lerp_wrapped(asteroids.prevX[i], asteroids.x[i], alpha, GAMEWIDTH),
+			lerp_wrapped(asteroids.prevY[i], asteroids.y[i], alpha, GAMEHEIGHT),
+			asteroids.radius[i], asteroids.radius[i], rock);
 	}
 
-	ck_optimize();
-
-	if (manyAsteroids.size() == 0)
+	for (size_t i = 0; i < explosions.size(); i++)
 	{
-		levelUp();
+		const AnimationInstance &anim = explosions.get(i);
+		const IntRect &frame = atlas.getRegion(explosions.getRegion(i));
+		spriteBatch.add(anim.x, anim.y, frame.width / 2.f, frame.height / 2.f, frame);
 	}
 
-	if (allExplosion.size() > 0)
-	{
-		for (int i = 0; i < allExplosion.size(); i++)
-		{
-			if (allExplosion[i]->isEnd())
-			{
-				allExplosion.erase(allExplosion.begin() + i);
-				continue;
-			}
-			allExplosion[i]->update();
-		}
-	}
-}
+	spriteBatch.draw(window);
 
-void setControl(float dt)
-{
-	if (Keyboard::isKeyPressed(Keyboard::A))
-	{
-		driftSound.play();
-		shiptDirState = "A";
-		tempShipVelocity = shipVelocity;
-		if (Keyboard::isKeyPressed(Keyboard::W))
-		{
-			shiptDirState = "AW";
-			ship.move(-shipVelocity * dt / 2, -shipVelocity * dt / 2);
-		}
-		else if (Keyboard::isKeyPressed(Keyboard::S))
-		{
-			shiptDirState = "AS";
-			ship.move(-shipVelocity * dt / 2, shipVelocity * dt / 2);
-		}
-		else
-		{
-			ship.move(-shipVelocity * dt, 0.f);
-		}
-	}
-	else if (Keyboard::isKeyPressed(Keyboard::D))
-	{
-		driftSound.play();
-		shiptDirState = "D";
-		tempShipVelocity = shipVelocity;
-		if (Keyboard::isKeyPressed(Keyboard::S))
-		{
-			shiptDirState = "DS";
-			ship.move(shipVelocity * dt / 2, shipVelocity * dt / 2);
-		}
-		else if (Keyboard::isKeyPressed(Keyboard::W))
-		{
-			shiptDirState = "DW";
-			ship.move(shipVelocity * dt / 2, -shipVelocity * dt / 2);
-		}
-		else
-		{
-			ship.move(shipVelocity * dt, 0.f);
-		}
-	}
-	else if (Keyboard::isKeyPressed(Keyboard::W))
-	{
-		driftSound.play();
-		shiptDirState = "W";
-		tempShipVelocity = shipVelocity;
-		
-		if (Keyboard::isKeyPressed(Keyboard::A))
-		{
-			shiptDirState = "WA";
-			ship.move(-shipVelocity * dt / 2, -shipVelocity * dt / 2);
-		}
-		else if (Keyboard::isKeyPressed(Keyboard::D))
-		{
-			shiptDirState = "WD";
-			ship.move(shipVelocity * dt / 2, -shipVelocity * dt / 2);
-		}
-		else
-		{
-			ship.move(0.f, -shipVelocity * dt);
-		}
-	}
-	else if (Keyboard::isKeyPressed(Keyboard::S))
-	{
-		driftSound.play();
-		shiptDirState = "S";
-		tempShipVelocity = shipVelocity;
-
-		if (Keyboard::isKeyPressed(Keyboard::A))
-		{
-			shiptDirState = "SA";
-			ship.move(-shipVelocity * dt / 2, shipVelocity * dt / 2);
-		}
-		else if (Keyboard::isKeyPressed(Keyboard::D))
-		{
-			shiptDirState = "SD";
-			ship.move(shipVelocity * dt / 2, shipVelocity * dt / 2);
-		}
-		else
-		{
-			ship.move(0.f, shipVelocity * dt);
-		}
-	}
-	else
-	{
-		driftSound.stop();
-		if (shiptDirState == "A")
-		{
-			if (tempShipVelocity - speedInterval < 0)
-			{
-				tempShipVelocity = 0;
-			}
-			tempShipVelocity -= speedInterval;
-			ship.move(-tempShipVelocity * dt, 0.f);
-		}
-		else if (shiptDirState == "AW")
-		{
-			if (tempShipVelocity - speedInterval < 0)
-			{
-				tempShipVelocity = 0;
-			}
-			tempShipVelocity -= speedInterval;
-			ship.move(-tempShipVelocity * dt / 2, -tempShipVelocity * dt / 2);
-		}
-		else if (shiptDirState == "AS")
-		{
-			if (tempShipVelocity - speedInterval < 0)
-			{
-				tempShipVelocity = 0;
-			}
-			tempShipVelocity -= speedInterval;
-			ship.move(-tempShipVelocity * dt / 2, tempShipVelocity * dt / 2);
-		}
-		else if (shiptDirState == "D")
-		{
-			if (tempShipVelocity - speedInterval < 0)
-			{
-				tempShipVelocity = 0;
-			}
-			tempShipVelocity -= speedInterval;
-			ship.move(tempShipVelocity * dt, 0.f);	
-		}
-		else if (shiptDirState == "DS")
-		{
-			if (tempShipVelocity - speedInterval < 0)
-			{
-				tempShipVelocity = 0;
-			}
-			tempShipVelocity -= speedInterval;
-			ship.move(tempShipVelocity * dt / 2, tempShipVelocity * dt / 2);
-		}
-		else if (shiptDirState == "DW")
-		{
-			if (tempShipVelocity - speedInterval < 0)
-			{
-				tempShipVelocity = 0;
-			}
-			tempShipVelocity -= speedInterval;
-			ship.move(tempShipVelocity * dt / 2, -tempShipVelocity * dt / 2);
-		}
-		else if (shiptDirState == "W")
-		{
-			if (tempShipVelocity - speedInterval < 0)
-			{
-				tempShipVelocity = 0;
-			}
-			tempShipVelocity -= speedInterval;
-			ship.move(0.f, -tempShipVelocity * dt);
-		}
-		else if (shiptDirState == "WA")
-		{
-			if (tempShipVelocity - speedInterval < 0)
-			{
-				tempShipVelocity = 0;
-			}
-			tempShipVelocity -= speedInterval;
-			ship.move(-tempShipVelocity * dt / 2, -tempShipVelocity * dt / 2);
-		}
-		else if (shiptDirState == "WD")
-		{
-			if (tempShipVelocity - speedInterval < 0)
-			{
-				tempShipVelocity = 0;
-			}
-			tempShipVelocity -= speedInterval;
-			ship.move(tempShipVelocity * dt / 2, -tempShipVelocity * dt / 2);
-		}
-		else if (shiptDirState == "S")
-		{
-			if (tempShipVelocity - speedInterval < 0)
-			{
-				tempShipVelocity = 0;
-			}
-			tempShipVelocity -= speedInterval;
-			ship.move(0.f, tempShipVelocity * dt);
-		}
-		else if (shiptDirState == "SA")
-		{
-			if (tempShipVelocity - speedInterval < 0)
-			{
-				tempShipVelocity = 0;
-			}
-			tempShipVelocity -= speedInterval;
-			ship.move(-tempShipVelocity * dt / 2, tempShipVelocity * dt / 2);
-		}
-		else if (shiptDirState == "SD")
-		{
-			if (tempShipVelocity - speedInterval < 0)
-			{
-				tempShipVelocity = 0;
-			}
-			tempShipVelocity -= speedInterval;
-			ship.move(tempShipVelocity * dt / 2, tempShipVelocity * dt / 2);
-		}
-		else
-		{
-			shiptDirState = "";
-		}
-	}
+	hud.draw(window);
 
-	if (Mouse::isButtonPressed(Mouse::Left))
+	if (showProfile)
 	{
-		shoot();
+#ifdef ASTEROID_PROFILE
+		profileTxt.setString(profiler.report());
+#else
+		profileTxt.setString("profiler not built in (configure with -DASTEROID_PROFILE=ON)");
+#endif
+		window.draw(profileTxt);
 	}
 }
 
-void shoot()
-{
-	shootSound.play();
-	Clock bulletClock;
-
-	Bullet *oneBullet = new Bullet(bulletClock);
-
-	float rotation = ship.getRotation() * PI / 180;
-
-	oneBullet->setRadius(bulletRadius);
-	oneBullet->setTexture(&bulletTexture);
-	//oneBullet->setFillColor(Color(100, 100, 200));
-	oneBullet->setOrigin(Vector2f(bulletRadius, bulletRadius));
-	oneBullet->setPosition(ship.getPosition().x + 80 * sin(rotation), ship.getPosition().y - 80 * cos(rotation));
-	oneBullet->setDirection(Vector2f(sin((rotation)), -cos((rotation))));
-	oneBullet->setVelocity(bulletVelocity); 
-
-	manyBullets.push_back(move(std::unique_ptr<Bullet>(oneBullet)));
-}
-
-void create_ast()
+// Turns what the simulation reported this frame into sounds and explosions.
+void play_events()
 {
-	for (size_t i = 0; i < 12; i++)
+	for (size_t i = 0; i < world.events.size(); i++)
 	{
-		int randomNum = std::rand();
-		int thisRadius = randomNum % 3;
-
-		Asteroid *oneAsteroid = new Asteroid();
-
-		switch (thisRadius)
+		const WorldEvent &event = world.events[i];
+		switch (event.type)
 		{
-		case 0:
-			oneAsteroid->setRadius(sAstRadius);
-			oneAsteroid->setOrigin(Vector2f(sAstRadius, sAstRadius));
+		case EventShoot:
+			sounds.play(shootEffect, 1.f);
 			break;
-		case 1:
-			oneAsteroid->setRadius(mAstRadius);
-			oneAsteroid->setOrigin(Vector2f(sAstRadius, sAstRadius));
+		case EventDrift:
+			sounds.setLooping(driftEffect, true);
 			break;
-		case 2:
-			oneAsteroid->setRadius(bAstRadius);
-			oneAsteroid->setOrigin(Vector2f(sAstRadius, sAstRadius));
+		case EventDriftStop:
+			sounds.setLooping(driftEffect, false);
+			break;
+		case EventExplode:
+			explosions.play(explosionClip, event.x, event.y);
+			sounds.play(explodeEffect, effectsRandom.uniform(0.9f, 1.1f));
+			break;
+		case EventCrash:
+			explosions.play(explosionClip, event.x, event.y);
+			sounds.play(crashEffect, 1.f);
+			break;
+		case EventLevelUp:
+			sounds.play(winEffect, 1.f);
+			explosions.clear();
 			break;
 		default:
 			break;
 		}
-		
-		oneAsteroid->setTexture(&astTexture);
-		oneAsteroid->setVelocity(astroidVelocity);
-
-		if (i<3)
-		{
-			oneAsteroid->setDirection(Vector2f(sin(randomNum), cos(randomNum)));
-			oneAsteroid->setPosition(randomNum % GAMEWIDTH, 1);
-		}
-		else if (i >= 3 && i < 7)
-		{
-			oneAsteroid->setDirection(Vector2f(sin(randomNum), cos(randomNum)));
-			oneAsteroid->setPosition(randomNum % GAMEWIDTH, GAMEHEIGHT - 1);
-		}
-		else if (i > 7 && i < 10)
-		{
-			oneAsteroid->setDirection(Vector2f(sin(randomNum), cos(randomNum)));
-			oneAsteroid->setPosition(1, randomNum % GAMEHEIGHT);
-		}
-		else
-		{
-			oneAsteroid->setDirection(Vector2f(sin(randomNum), cos(randomNum)));
-			oneAsteroid->setPosition(GAMEWIDTH - 1, randomNum % GAMEHEIGHT);
-		}
-
-		//grid[checkGrid(oneAsteroid->getPosition())].push_back(move(std::unique_ptr<Asteroid>(oneAsteroid)));
-		manyAsteroids.push_back(move(std::unique_ptr<Asteroid>(oneAsteroid)));
 	}
 }
 
-void ast_get_hit(Asteroid *theAst, int index)
+void update_hud()
 {
-	Animation *playAnim = new Animation(explosion, 0, 0, 192, 192, 64, 0.6);
-	playAnim->sprite.setPosition(theAst->getPosition());
-	allExplosion.push_back(playAnim);
-	explodeSound.play();
-
-	if (theAst->getRadius() == bAstRadius)
-	{
-		theAst->setRadius(mAstRadius);
-		theAst->setDirection(Vector2f(1, 1));
-		theAst->setVelocity(astroidVelocity);
-		float theAstX = theAst->getPosition().x;
-		float theAstY = theAst->getPosition().y;
-
-		Asteroid *dividedAsteroid = new Asteroid();
-		dividedAsteroid->setRadius(mAstRadius);
-		dividedAsteroid->setTexture(&astTexture);
-		dividedAsteroid->setVelocity(astroidVelocity);
-		dividedAsteroid->setDirection(Vector2f(1, 0));
-		dividedAsteroid->setPosition(theAstX, theAstY);
-
-		asteroidsAdded.push_back(dividedAsteroid);
-	}
-	else if (theAst->getRadius() == mAstRadius)
-	{
-		theAst->setRadius(sAstRadius);
-		theAst->setDirection(Vector2f(1, 1));
-		theAst->setVelocity(astroidVelocity);
-		float theAstX = theAst->getPosition().x;
-		float theAstY = theAst->getPosition().y;
-
-		Asteroid *dividedAsteroid = new Asteroid();
-		dividedAsteroid->setRadius(sAstRadius);
-		dividedAsteroid->setTexture(&astTexture);
-		dividedAsteroid->setVelocity(astroidVelocity);
-		dividedAsteroid->setDirection(Vector2f(1, 0));
-		dividedAsteroid->setPosition(theAstX, theAstY);
-
-		asteroidsAdded.push_back(dividedAsteroid);
-	}
-	else if (theAst->getRadius() == sAstRadius)
-	{
-		manyAsteroids.erase(manyAsteroids.begin() + index);
-		score++;
-	}
+	hud.set(hudLife, world.life);
+	hud.set(hudScore, world.score);
+	hud.set(hudLevel, world.level);
 }
 
-void ast_bounce (Asteroid *ast1, Asteroid *ast2)
+void update_effects()
 {
-	Vector2f aaa = ast1->getPosition() - ast2->getPosition();
-	aaa = aaa / sqrt(pow(aaa.x, 2) + pow(aaa.y, 2));
-	ast1->setDirection(aaa);
-	ast2->setDirection(-aaa);
-}
+	TRACE_SCOPE("explosions");
 
-void make_it_invincible()
-{
-	if (flashTimer == 0)
-	{
-		ship.setTexture(&shipSprite);
-		flashTimer = 100;
-	}
-	else if (flashTimer % 2 == 0)
-	{
-		ship.setFillColor(shellColor);
-		flashTimer--;
-	}
-	else
-	{
-		ship.setFillColor(shellColor);
-		flashTimer--;
-	}
-}
-
-int checkGrid(Vector2f ptPos)
-{
-	int xUnit = GAMEWIDTH / 3;
-	int yUnit = GAMEHEIGHT / 3;
+	update_hud();
 
-	int col = ptPos.x / xUnit;
-	int row = ptPos.y / yUnit;
-
-	if (col >= 3)
-	{
-		col = 2;
-	}
-
-	if (col <= 0)
-	{
-		col = 0;
-	}
-
-	if (row >= 3)
-	{
-		row = 2;
-	}
-
-	if (row <= 0)
-	{
-		row = 0;
-	}
-
-	return (row + 1) + col * 3 - 1;
+	explosions.update();
 }
 
-void collision_check(CircleShape *obj1, CircleShape *obj2)
+void restart()
 {
-	Vector2f onePos = obj1->getPosition();
-	Vector2f twoPos = obj2->getPosition();
-
-	float distance = sqrt(pow(twoPos.x-onePos.x, 2) + pow(twoPos.y - onePos.y, 2));
-
-	if (is_collided(obj1, obj2))
-	{
-		if (dynamic_cast<SpaceShip *>(obj1) != nullptr || dynamic_cast<SpaceShip *>(obj2) != nullptr)
-		{
-			life--;
-		}
-		else if (dynamic_cast<Bullet *>(obj1) != nullptr && dynamic_cast<Asteroid *>(obj2) != nullptr)
-		{
-			Bullet * theBullet = dynamic_cast<Bullet *>(obj1);
-			Asteroid * theAsteroid = dynamic_cast<Asteroid *>(obj2);
-			for (size_t i = manyBullets.size() - 1; i >=0 ; i--)
-			{
-				if (manyBullets[i].get() == theBullet)
-				{
-					//manyBullets.erase(manyBullets.begin() + i);
-					break;
-				}
-			}
-			for (size_t i = manyAsteroids.size() - 1; i >= 0; i--)
-			{
-				if (manyAsteroids[i].get() == theAsteroid)
-				{
-					for (size_t j = grid[checkGrid(theAsteroid->getPosition())].size() - 1; j >= 0; j--)
-					{
-						if (grid[checkGrid(theAsteroid->getPosition())][j].get() == theAsteroid)
-						{
-							//ast_get_hit(theAsteroid, i);
-							break;
-						}
-					}
-					break;
-				}
-			}
-		}
-		else if (dynamic_cast<Asteroid *>(obj1) != nullptr && dynamic_cast<Bullet *>(obj2) != nullptr)
-		{
-			Bullet * theBullet = dynamic_cast<Bullet *>(obj2);
-			Asteroid * theAsteroid = dynamic_cast<Asteroid *>(obj1);
-			for (size_t i = manyBullets.size() - 1; i >= 0; i--)
-			{
-				if (manyBullets[i].get() == theBullet)
-				{
-					manyBullets.erase(manyBullets.begin() + i);
-					break;
-				}
-			}
-			for (size_t i = manyAsteroids.size() - 1; i >= 0; i--)
-			{
-				if (manyAsteroids[i].get() == theAsteroid)
-				{
-					for (size_t j = grid[checkGrid(theAsteroid->getPosition())].size() - 1; j >= 0; j--)
-					{
-						if (grid[checkGrid(theAsteroid->getPosition())][j].get() == theAsteroid)
-						{
-							grid[checkGrid(theAsteroid->getPosition())].erase(grid[checkGrid(theAsteroid->getPosition())].begin() + j);
-							break;
-						}
-					}
-					//manyAsteroids.erase(manyAsteroids.begin() + i);
-					break;
-				}
-			}
-		}
-		else if (dynamic_cast<Asteroid *>(obj1) != nullptr && dynamic_cast<Asteroid *>(obj2) != nullptr)
-		{
-			ast_bounce(dynamic_cast<Asteroid *>(obj1), dynamic_cast<Asteroid *>(obj2));
-		}
-	}
+	GameState = 1;
+	restartPending = true;
+	explosions.clear();
+	world.restart();
+	timestep.reset();
 }
 
-void ck_optimize()
+// Runs recorded ticks in place of the keyboard. The pause and game over
+// screens are skipped: the recording already says when the game restarted.
+// The window closes when the recording ends.
+void play_replay(float frameTime)
 {
-	for (int i = manyAsteroids.size() - 1; i >= 0; i--)
+	int ticks = replayFast ? 1 : timestep.advance(frameTime);
+	for (int t = 0; t < ticks; t++)
 	{
-		if (is_collided(manyAsteroids[i].get(), &ship))
+		Input input;
+		bool restarted;
+		if (!replay.next(input, restarted))
 		{
-			Animation *playAnim = new Animation(explosion, 0, 0, 192, 192, 64, 0.6);
-			playAnim->sprite.setPosition(ship.getPosition());
-			allExplosion.push_back(playAnim);
-			crashSound.play();
-
-			life--;
-			respawn();
-			break;
+			window.close();
+			return;
 		}
 
-		for (int k = manyAsteroids.size() - 1; k >= 0; k--)
+		if (restarted)
 		{
-			if (is_collided(manyAsteroids[i].get(), manyAsteroids[k].get()))
-			{
-				ast_bounce(manyAsteroids[i].get(), manyAsteroids[k].get());
-			}
+			restart();
 		}
-
-		if (manyBullets.size() != 0)
 		{
-			for (int j = manyBullets.size() - 1; j >= 0 ; j--)
-			{
-				if (is_collided(manyAsteroids[i].get(), manyBullets[j].get()))
-				{
-					manyBullets.erase(manyBullets.begin() + j);
-					ast_get_hit(manyAsteroids[i].get(), i);
-					break;
-				}
-			}
+			TRACE_SCOPE("update");
+			world.step(input, timestep.getTickLength());
 		}
+		play_events();
+		update_effects();
 	}
 
-	if (asteroidsAdded.size() > 0)
-	{
-		manyAsteroids.insert(manyAsteroids.end(), asteroidsAdded.begin(), asteroidsAdded.end());
-		asteroidsAdded.clear();
-	}
-}
-
-bool is_collided(CircleShape *obj1, CircleShape *obj2)
-{
-	if (obj1 == obj2)
-	{
-		return false;
-	}
-
-	Vector2f onePos = obj1->getPosition();
-	Vector2f twoPos = obj2->getPosition();
-
-	float distance = sqrt(pow(twoPos.x - onePos.x, 2) + pow(twoPos.y - onePos.y, 2));
-
-	return distance <= (obj1->getRadius() + obj2->getRadius());
-}
-
-void restart() 
-{
-	astroidVelocity = 250;
-	level = 1;
-	score = 0;
-	GameState = 1;
-	life = 3;
-	manyBullets.clear();
-	manyAsteroids.clear();
-	allExplosion.clear();
-	create_ast();
-	ship.setPosition(Vector2f(GAMEWIDTH / 2, GAMEHEIGHT / 2));
-}
-
-void respawn()
-{
-	manyBullets.clear();
-	ship.setPosition(Vector2f(GAMEWIDTH / 2, GAMEHEIGHT / 2));
-}
-
-void levelUp()
-{
-	winSound.play();
-	level++;
-	manyBullets.clear();
-	manyAsteroids.clear();
-	allExplosion.clear();
-	astroidVelocity += 50;
-	create_ast();
-	ship.setPosition(Vector2f(GAMEWIDTH / 2, GAMEHEIGHT / 2));
+	render_frame(replayFast ? 1.f : timestep.alpha());
+#ifdef ASTEROID_PROFILE
+	profiler.endFrame();
+#endif
 }
@@ -0,0 +1,171 @@
+#include "NarrowPhase.h"
+
+#include <cmath>
+
+#ifdef SIMD_SSE2
+#include <emmintrin.h>
+#endif
+
+size_t circle_hits_scalar(float x, float y, float radius, const float *xs, const float *ys, const float *radii, size_t count, unsigned char *hits)
+{
+	size_t hitCount = 0;
+	for (size_t k = 0; k < count; k++)
+	{
+		float dx = xs[k] - x;
+		float dy = ys[k] - y;
+		float reach = radii[k] + radius;
+
+		hits[k] = dx * dx + dy * dy <= reach * reach;
+		hitCount += hits[k];
+	}
+	return hitCount;
+}
+
+#ifdef SIMD_SSE2
+// all-ones lanes where candidates [k, k + 4) touch the query circle
+static inline __m128i hit_lanes4(__m128 qx, __m128 qy, __m128 qr, const float *xs, const float *ys, const float *radii, size_t k)
+{
+	__m128 dx = _mm_sub_ps(_mm_loadu_ps(xs + k), qx);
+	__m128 dy = _mm_sub_ps(_mm_loadu_ps(ys + k), qy);
+	__m128 reach = _mm_add_ps(_mm_loadu_ps(radii + k), qr);
+	__m128 distance = _mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy));
+
+	return _mm_castps_si128(_mm_cmple_ps(distance, _mm_mul_ps(reach, reach)));
+}
+
+size_t circle_hits_sse2(float x, float y, float radius, const float *xs, const float *ys, const float *radii, size_t count, unsigned char *hits)
+{
+	const __m128 qx = _mm_set1_ps(x);
+	const __m128 qy = _mm_set1_ps(y);
+	const __m128 qr = _mm_set1_ps(radius);
+	const __m128i ones = _mm_set1_epi8(1);
+
+	// 16 candidates per step, narrowed to one byte each and stored at once
+	__m128i hitSum = _mm_setzero_si128();
+	size_t k = 0;
+	for (; k + 16 <= count; k += 16)
+	{
+		__m128i low = _mm_packs_epi32(hit_lanes4(qx, qy, qr, xs, ys, radii, k), hit_lanes4(qx, qy, qr, xs, ys, radii, k + 4));
+		__m128i high = _mm_packs_epi32(hit_lanes4(qx, qy, qr, xs, ys, radii, k + 8), hit_lanes4(qx, qy, qr, xs, ys, radii, k + 12));
+		__m128i bytes = _mm_and_si128(_mm_packs_epi16(low, high), ones);
+
+		_mm_storeu_si128((__m128i *)(hits + k), bytes);
+		hitSum = _mm_add_epi64(hitSum, _mm_sad_epu8(bytes, _mm_setzero_si128()));
+	}
+
+	size_t hitCount = (size_t)_mm_cvtsi128_si32(hitSum) + (size_t)_mm_cvtsi128_si32(_mm_srli_si128(hitSum, 8));
+	return hitCount + circle_hits_scalar(x, y, radius, xs + k, ys + k, radii + k, count - k, hits + k);
+}
+#else
+size_t circle_hits_sse2(float x, float y, float radius, const float *xs, const float *ys, const float *radii, size_t count, unsigned char *hits)
+{
+	return circle_hits_scalar(x, y, radius, xs, ys, radii, count, hits);
+}
+#endif
+
+CircleHitsKernel circle_hits_kernel(int path)
+{
+	switch (path)
+	{
+	case SimdSSE2:
+		return circle_hits_sse2;
+	case SimdAVX2:
+		return circle_hits_avx2;
+	default:
+		return circle_hits_scalar;
+	}
+}
+
+size_t circle_hits(float x, float y, float radius, const float *xs, const float *ys, const float *radii, size_t count, unsigned char *hits)
+{
+	return circle_hits_kernel(simd_path())(x, y, radius, xs, ys, radii, count, hits);
+}
+
+// Solves |(x, y) + t (moveX, moveY)| = reach for the smaller root. Touching at
+// the start counts as t = 0; if the circles start apart, both roots have the
+// same sign, so a negative smaller root means they are moving apart.
+float swept_contact_time(float x, float y, float moveX, float moveY, float reach)
+{
+	float c = x * x + y * y - reach * reach;
+	if (c <= 0)
+	{
+		return 0;
+	}
+
+	float a = moveX * moveX + moveY * moveY;
+	float b = x * moveX + y * moveY;
+	float discriminant = b * b - a * c;
+	if (b >= 0 || discriminant < 0)
+	{
+		return -1;
+	}
+
+	float t = (-b - std::sqrt(discriminant)) / a;
+	return t <= 1 ? t : -1;
+}
+
+CandidateBatch::CandidateBatch()
+{
+}
+
+void CandidateBatch::clear()
+{
+	this->index.clear();
+	this->x.clear();
+	this->y.clear();
+	this->radius.clear();
+	this->moveX.clear();
+	this->moveY.clear();
+}
+
+void CandidateBatch::add(int index, float x, float y, float radius)
+{
+	this->index.push_back(index);
+	this->x.push_back(x);
+	this->y.push_back(y);
+	this->radius.push_back(radius);
+}
+
+// A candidate at (x, y) at the start of the tick that moved by (moveX, moveY).
+void CandidateBatch::addMoving(int index, float x, float y, float moveX, float moveY, float radius)
+{
+	this->add(index, x, y, radius);
+	this->moveX.push_back(moveX);
+	this->moveY.push_back(moveY);
+}
+
+size_t CandidateBatch::size() const
+{
+	return this->index.size();
+}
+
+// Tests every candidate against the circle at (x, y); hits[k] belongs to index[k].
+size_t CandidateBatch::test(float x, float y, float radius)
+{
+	this->hits.resize(this->index.size());
+	return circle_hits(x, y, radius, this->x.data(), this->y.data(), this->radius.data(), this->index.size(), this->hits.data());
+}
+
+// Sweeps every candidate against the circle that started the tick at (x, y)
+// and moved by (moveX, moveY). Scalar only: bullets are few next to the
+// asteroid pairs circle_hits() handles.
+size_t CandidateBatch::testSwept(float x, float y, float moveX, float moveY, float radius)
+{
+	size_t count = this->index.size();
+	this->hits.resize(count);
+	this->times.resize(count);
+
+	size_t hitCount = 0;
+	for (size_t k = 0; k < count; k++)
+	{
+		float time = swept_contact_time(this->x[k] - x, this->y[k] - y, this->moveX[k] - moveX, this->moveY[k] - moveY, this->radius[k] + radius);
+		this->times[k] = time;
+		this->hits[k] = time >= 0;
+		hitCount += this->hits[k];
+	}
+	return hitCount;
+}
+
+CandidateBatch::~CandidateBatch()
+{
+}
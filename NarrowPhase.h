@@ -0,0 +1,55 @@
+#pragma once
+#include <cstddef>
+#include <vector>
+
+#include "SimdPath.h"
+
+// Narrow phase for circles: one query circle against a packed run of
+// candidate circles. hits[k] is set to 1 where candidate k overlaps the query
+// (touching counts) and to 0 elsewhere; the return value is the number of
+// hits. Distances are compared squared, so there is no sqrt, and the scalar,
+// SSE2 and AVX2 versions give identical masks.
+typedef size_t (*CircleHitsKernel)(float, float, float, const float *, const float *, const float *, size_t, unsigned char *);
+
+size_t circle_hits(float, float, float, const float *, const float *, const float *, size_t, unsigned char *);
+
+// single versions, for benchmarks
+size_t circle_hits_scalar(float, float, float, const float *, const float *, const float *, size_t, unsigned char *);
+size_t circle_hits_sse2(float, float, float, const float *, const float *, const float *, size_t, unsigned char *);
+size_t circle_hits_avx2(float, float, float, const float *, const float *, const float *, size_t, unsigned char *);
+CircleHitsKernel circle_hits_kernel(int);
+
+// Swept test for two moving circles: the earliest fraction t in [0, 1] of the
+// tick at which they touch, or -1 if they never do. (x, y) is where the other
+// circle starts relative to this one, (moveX, moveY) how far it moves relative
+// to this one during the tick, and reach the sum of the radii.
+float swept_contact_time(float, float, float, float, float);
+
+// Candidates from a broadphase query copied into packed columns so they can
+// be tested in one circle_hits() call. Kept between queries so the columns
+// stop allocating once they have grown.
+//
+// A batch filled with addMoving() instead, which also records where each
+// candidate started the tick and how far it moved, is tested with
+// testSwept(); times[k] then holds candidate k's contact time.
+class CandidateBatch
+{
+public:
+	std::vector<int> index;
+	std::vector<float> x;
+	std::vector<float> y;
+	std::vector<float> radius;
+	std::vector<float> moveX;
+	std::vector<float> moveY;
+	std::vector<unsigned char> hits;
+	std::vector<float> times;
+
+	CandidateBatch();
+	void clear();
+	void add(int, float, float, float);
+	void addMoving(int, float, float, float, float, float);
+	size_t size() const;
+	size_t test(float, float, float);
+	size_t testSwept(float, float, float, float, float);
+	~CandidateBatch();
+};
@@ -0,0 +1,49 @@
+// Built with AVX2 code generation enabled, like IntegrateAVX2.cpp.
+#include "NarrowPhase.h"
+
+#ifdef __AVX2__
+#include <immintrin.h>
+
+// all-ones lanes where candidates [k, k + 8) touch the query circle
+static inline __m256i hit_lanes8(__m256 qx, __m256 qy, __m256 qr, const float *xs, const float *ys, const float *radii, size_t k)
+{
+	__m256 dx = _mm256_sub_ps(_mm256_loadu_ps(xs + k), qx);
+	__m256 dy = _mm256_sub_ps(_mm256_loadu_ps(ys + k), qy);
+	__m256 reach = _mm256_add_ps(_mm256_loadu_ps(radii + k), qr);
+	__m256 distance = _mm256_add_ps(_mm256_mul_ps(dx, dx), _mm256_mul_ps(dy, dy));
+
+	return _mm256_castps_si256(_mm256_cmp_ps(distance, _mm256_mul_ps(reach, reach), _CMP_LE_OS));
+}
+
+size_t circle_hits_avx2(float x, float y, float radius, const float *xs, const float *ys, const float *radii, size_t count, unsigned char *hits)
+{
+	const __m256 qx = _mm256_set1_ps(x);
+	const __m256 qy = _mm256_set1_ps(y);
+	const __m256 qr = _mm256_set1_ps(radius);
+	const __m256i ones = _mm256_set1_epi8(1);
+	// the packs work inside each 128-bit half; this puts the dwords back in order
+	const __m256i unshuffle = _mm256_setr_epi32(0, 4, 1, 5, 2, 6, 3, 7);
+
+	// 32 candidates per step, narrowed to one byte each and stored at once
+	__m256i hitSum = _mm256_setzero_si256();
+	size_t k = 0;
+	for (; k + 32 <= count; k += 32)
+	{
+		__m256i low = _mm256_packs_epi32(hit_lanes8(qx, qy, qr, xs, ys, radii, k), hit_lanes8(qx, qy, qr, xs, ys, radii, k + 8));
+		__m256i high = _mm256_packs_epi32(hit_lanes8(qx, qy, qr, xs, ys, radii, k + 16), hit_lanes8(qx, qy, qr, xs, ys, radii, k + 24));
+		__m256i bytes = _mm256_and_si256(_mm256_permutevar8x32_epi32(_mm256_packs_epi16(low, high), unshuffle), ones);
+
+		_mm256_storeu_si256((__m256i *)(hits + k), bytes);
+		hitSum = _mm256_add_epi64(hitSum, _mm256_sad_epu8(bytes, _mm256_setzero_si256()));
+	}
+
+	__m128i halves = _mm_add_epi64(_mm256_castsi256_si128(hitSum), _mm256_extracti128_si256(hitSum, 1));
+	size_t hitCount = (size_t)_mm_cvtsi128_si32(halves) + (size_t)_mm_cvtsi128_si32(_mm_srli_si128(halves, 8));
+	return hitCount + circle_hits_sse2(x, y, radius, xs + k, ys + k, radii + k, count - k, hits + k);
+}
+#else
+size_t circle_hits_avx2(float x, float y, float radius, const float *xs, const float *ys, const float *radii, size_t count, unsigned char *hits)
+{
+	return circle_hits_sse2(x, y, radius, xs, ys, radii, count, hits);
+}
+#endif
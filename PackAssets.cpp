@@ -0,0 +1,43 @@
+// Builds the asset pack the game maps at startup, then reopens it and checks
+// every entry, printing the table of contents.
+//
+// usage: asteroid_pack OUTPUT FILE...
+
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include "AssetPack.h"
+
+int main(int argc, char **argv)
+{
+	if (argc < 3)
+	{
+		std::fprintf(stderr, "usage: %s OUTPUT FILE...\n", argv[0]);
+		return 2;
+	}
+
+	std::vector<std::string> files(argv + 2, argv + argc);
+	if (!write_asset_pack(argv[1], files))
+	{
+		return 1;
+	}
+
+	AssetPack pack;
+	if (!pack.open(argv[1]))
+	{
+		std::fprintf(stderr, "cannot map %s after writing it\n", argv[1]);
+		return 1;
+	}
+
+	bool ok = true;
+	for (int i = 0; i < pack.getCount(); i++)
+	{
+		const AssetPackEntry &entry = pack.getEntry(i);
+		bool intact = pack.verify(i);
+		std::printf("%-20s %10u bytes at %10u  %016llx%s\n", entry.name.c_str(), (unsigned)entry.size, (unsigned)entry.offset,
+			entry.checksum, intact ? "" : "  BAD");
+		ok = ok && intact;
+	}
+	return ok ? 0 : 1;
+}
@@ -0,0 +1,170 @@
+#include "Profiler.h"
+
+#include <algorithm>
+
+Profiler profiler;
+
+static const char *SECTION_NAMES[ProfileSectionCount] = { "setControl", "update_state", "ck_optimize", "render_frame", "display" };
+static const char *COUNTER_NAMES[ProfileCounterCount] = { "asteroids", "bullets", "collision_tests" };
+
+const char *profile_section_name(int section)
+{
+	return SECTION_NAMES[section];
+}
+
+const char *profile_counter_name(int counter)
+{
+	return COUNTER_NAMES[counter];
+}
+
+Profiler::Profiler()
+	: history(ProfileSectionCount * PROFILE_WINDOW, 0.f)
+{
+	std::fill(this->frameTimes, this->frameTimes + ProfileSectionCount, 0.0);
+	std::fill(this->frameCounts, this->frameCounts + ProfileCounterCount, 0LL);
+	std::fill(this->lastCounts, this->lastCounts + ProfileCounterCount, 0LL);
+	this->scratch.reserve(PROFILE_WINDOW);
+	this->frames = 0;
+	this->csv = nullptr;
+}
+
+void Profiler::add(int section, Clock::duration time)
+{
+	this->frameTimes[section] += std::chrono::duration<double, std::milli>(time).count();
+}
+
+void Profiler::count(int counter, long long n)
+{
+	this->frameCounts[counter] += n;
+}
+
+// Closes the current frame: stores its times in the history, writes its CSV
+// row and starts the next one from zero.
+void Profiler::endFrame()
+{
+	int slot = this->frames % PROFILE_WINDOW;
+	for (int s = 0; s < ProfileSectionCount; s++)
+	{
+		this->history[s * PROFILE_WINDOW + slot] = (float)this->frameTimes[s];
+	}
+
+	if (this->csv)
+	{
+		std::fprintf(this->csv, "%d", this->frames);
+		for (int s = 0; s < ProfileSectionCount; s++)
+		{
+			std::fprintf(this->csv, ",%.4f", this->frameTimes[s]);
+		}
+		for (int c = 0; c < ProfileCounterCount; c++)
+		{
+			std::fprintf(this->csv, ",%lld", this->frameCounts[c]);
+		}
+		std::fprintf(this->csv, "\n");
+	}
+
+	this->frames++;
+	std::copy(this->frameCounts, this->frameCounts + ProfileCounterCount, this->lastCounts);
+	std::fill(this->frameTimes, this->frameTimes + ProfileSectionCount, 0.0);
+	std::fill(this->frameCounts, this->frameCounts + ProfileCounterCount, 0LL);
+}
+
+// Minimum, mean and 99th percentile of a section over the recorded frames, in
+// milliseconds.
+void Profiler::stats(int section, float &min, float &avg, float &p99)
+{
+	int samples = std::min(this->frames, PROFILE_WINDOW);
+	if (samples == 0)
+	{
+		min = avg = p99 = 0.f;
+		return;
+	}
+
+	const float *times = &this->history[section * PROFILE_WINDOW];
+	this->scratch.assign(times, times + samples);
+
+	float sum = 0.f;
+	for (int i = 0; i < samples; i++)
+	{
+		sum += this->scratch[i];
+	}
+	avg = sum / samples;
+	min = *std::min_element(this->scratch.begin(), this->scratch.end());
+
+	std::vector<float>::iterator rank = this->scratch.begin() + (samples * 99) / 100;
+	std::nth_element(this->scratch.begin(), rank, this->scratch.end());
+	p99 = *rank;
+}
+
+// One line per section and the counters of the last finished frame, for the
+// overlay and the headless summary.
+std::string Profiler::report()
+{
+	std::string text;
+	char line[128];
+
+	std::snprintf(line, sizeof(line), "%-14s %7s %7s %7s\n", "ms", "min", "avg", "p99");
+	text += line;
+	for (int s = 0; s < ProfileSectionCount; s++)
+	{
+		float min, avg, p99;
+		this->stats(s, min, avg, p99);
+		std::snprintf(line, sizeof(line), "%-14s %7.3f %7.3f %7.3f\n", SECTION_NAMES[s], min, avg, p99);
+		text += line;
+	}
+	for (int c = 0; c < ProfileCounterCount; c++)
+	{
+		std::snprintf(line, sizeof(line), "%-14s %7lld\n", COUNTER_NAMES[c], this->lastCounts[c]);
+		text += line;
+	}
+	return text;
+}
+
+// Starts writing one row per frame to path. Returns false if it cannot be
+// opened.
+bool Profiler::openCsv(const char *path)
+{
+	this->closeCsv();
+	this->csv = std::fopen(path, "w");
+	if (!this->csv)
+	{
+		return false;
+	}
+
+	std::fprintf(this->csv, "frame");
+	for (int s = 0; s < ProfileSectionCount; s++)
+	{
+		std::fprintf(this->csv, ",%s_ms", SECTION_NAMES[s]);
+	}
+	for (int c = 0; c < ProfileCounterCount; c++)
+	{
+		std::fprintf(this->csv, ",%s", COUNTER_NAMES[c]);
+	}
+	std::fprintf(this->csv, "\n");
+	return true;
+}
+
+void Profiler::closeCsv()
+{
+	if (this->csv)
+	{
+		std::fclose(this->csv);
+		this->csv = nullptr;
+	}
+}
+
+Profiler::~Profiler()
+{
+	this->closeCsv();
+}
+
+Profiler::Scope::Scope(Profiler &profiler, int section)
+	: profiler(profiler)
+{
+	this->section = section;
+	this->start = Clock::now();
+}
+
+Profiler::Scope::~Scope()
+{
+	this->profiler.add(this->section, Clock::now() - this->start);
+}
@@ -0,0 +1,92 @@
+#pragma once
+#include <chrono>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+// Sections of a frame that get a scoped timer. Scopes may nest (ck_optimize()
+// runs inside update_state()); every section reports its own inclusive time.
+enum ProfileSection
+{
+	ProfileSetControl,
+	ProfileUpdateState,
+	ProfileCollide,
+	ProfileRender,
+	ProfileDisplay,
+	ProfileSectionCount
+};
+
+// Per-frame counts, reported next to the timings.
+enum ProfileCounter
+{
+	CounterAsteroids,
+	CounterBullets,
+	CounterCollisionTests,
+	ProfileCounterCount
+};
+
+// frames the rolling min/avg/p99 are taken over
+const int PROFILE_WINDOW = 240;
+
+// Collects section times and counters for the current frame and keeps the last
+// PROFILE_WINDOW frames for statistics. Optionally writes one CSV row per
+// frame. Only the main thread may time scopes or count.
+//
+// The timers are steady_clock: rdtsc would be cheaper but needs calibrating
+// and is not steady across cores on every machine we run on.
+class Profiler
+{
+private:
+	typedef std::chrono::steady_clock Clock;
+
+	double frameTimes[ProfileSectionCount];
+	long long frameCounts[ProfileCounterCount];
+	long long lastCounts[ProfileCounterCount];
+	// PROFILE_WINDOW samples per section, written round robin
+	std::vector<float> history;
+	std::vector<float> scratch;
+	int frames;
+	FILE *csv;
+
+public:
+	Profiler();
+	void add(int, Clock::duration);
+	void count(int, long long);
+	void endFrame();
+	void stats(int, float &, float &, float &);
+	std::string report();
+	bool openCsv(const char *);
+	void closeCsv();
+	~Profiler();
+
+	// Adds the time until it goes out of scope to a section.
+	class Scope
+	{
+	private:
+		Profiler &profiler;
+		int section;
+		Clock::time_point start;
+
+	public:
+		Scope(Profiler &, int);
+		~Scope();
+	};
+};
+
+const char *profile_section_name(int);
+const char *profile_counter_name(int);
+
+// the one the PROFILE_ macros feed
+extern Profiler profiler;
+
+// Both macros compile to nothing unless ASTEROID_PROFILE is defined, so the
+// release game pays nothing for them.
+#ifdef ASTEROID_PROFILE
+#define PROFILE_JOIN2(a, b) a##b
+#define PROFILE_JOIN(a, b) PROFILE_JOIN2(a, b)
+#define PROFILE_SCOPE(section) Profiler::Scope PROFILE_JOIN(profileScope, __LINE__)(profiler, section)
+#define PROFILE_COUNT(counter, n) profiler.count(counter, n)
+#else
+#define PROFILE_SCOPE(section) ((void)0)
+#define PROFILE_COUNT(counter, n) ((void)0)
+#endif
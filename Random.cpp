@@ -0,0 +1,82 @@
+#include "Random.h"
+
+static const uint64_t PCG_MULTIPLIER = 6364136223846793005ULL;
+static const float TWO_PI = 6.2831853f;
+
+Random::Random()
+{
+	this->seed(0, 0);
+}
+
+Random::Random(uint64_t seed, uint64_t stream)
+{
+	this->seed(seed, stream);
+}
+
+// Restarts the generator on sequence stream at position seed.
+void Random::seed(uint64_t seed, uint64_t stream)
+{
+	this->state = 0;
+	this->increment = stream << 1 | 1;
+	this->next();
+	this->state += seed;
+	this->next();
+}
+
+uint32_t Random::next()
+{
+	uint64_t old = this->state;
+	this->state = old * PCG_MULTIPLIER + this->increment;
+
+	uint32_t shifted = (uint32_t)(((old >> 18) ^ old) >> 27);
+	uint32_t rotation = (uint32_t)(old >> 59);
+	return shifted >> rotation | shifted << ((0u - rotation) & 31);
+}
+
+// In [0, bound). Scaling by multiply and shift leaves a bias of at most
+// bound / 2^32, far below anything a game can notice.
+uint32_t Random::below(uint32_t bound)
+{
+	return (uint32_t)(((uint64_t)this->next() * bound) >> 32);
+}
+
+// In [0, 1), from the top 24 bits so every value is exact in a float.
+float Random::uniform()
+{
+	return (this->next() >> 8) * (1.f / 16777216.f);
+}
+
+float Random::uniform(float min, float max)
+{
+	return min + (max - min) * this->uniform();
+}
+
+// In [0, 2 pi), radians.
+float Random::angle()
+{
+	return this->uniform() * TWO_PI;
+}
+
+// count draws of below(bound), for setting up a whole wave in one go. The
+// fills call the single draws, which inline here, so the two cannot drift
+// apart.
+void Random::fillBelow(uint32_t *out, size_t count, uint32_t bound)
+{
+	for (size_t i = 0; i < count; i++)
+	{
+		out[i] = this->below(bound);
+	}
+}
+
+// count draws of uniform(min, max).
+void Random::fillUniform(float *out, size_t count, float min, float max)
+{
+	for (size_t i = 0; i < count; i++)
+	{
+		out[i] = this->uniform(min, max);
+	}
+}
+
+Random::~Random()
+{
+}
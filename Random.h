@@ -0,0 +1,36 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+
+// Independent random streams drawn from one session seed, so that, say, more
+// explosions on screen never change where the next wave spawns.
+enum RandomStream
+{
+	RandomSpawn,
+	RandomSplit,
+	RandomEffects
+};
+
+// PCG32 (O'Neill, pcg-random.org): 64 bits of state, 32-bit output, and a
+// stream id that picks one of 2^63 sequences for the same seed. It gives the
+// same numbers on every platform and compiler, unlike std::rand(), and each
+// generator is a plain value, so threads can own one each.
+class Random
+{
+private:
+	uint64_t state;
+	uint64_t increment;
+
+public:
+	Random();
+	Random(uint64_t, uint64_t);
+	void seed(uint64_t, uint64_t);
+	uint32_t next();
+	uint32_t below(uint32_t);
+	float uniform();
+	float uniform(float, float);
+	float angle();
+	void fillBelow(uint32_t *, size_t, uint32_t);
+	void fillUniform(float *, size_t, float, float);
+	~Random();
+};
@@ -0,0 +1,98 @@
+#include "SimdPath.h"
+
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#include <intrin.h>
+#endif
+
+// set in IntegrateAVX2.cpp, false when the AVX2 kernels were built without AVX2
+extern const bool simdAvx2Built;
+
+static bool cpu_has_avx2()
+{
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+	return __builtin_cpu_supports("avx2");
+#elif defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+	int info[4];
+	__cpuid(info, 0);
+	if (info[0] < 7)
+	{
+		return false;
+	}
+	__cpuid(info, 1);
+	bool osSavesYmm = (info[2] & (1 << 27)) != 0 && (_xgetbv(0) & 6) == 6;
+	__cpuidex(info, 7, 0);
+	return osSavesYmm && (info[1] & (1 << 5)) != 0;
+#else
+	return false;
+#endif
+}
+
+bool simd_path_supported(int path)
+{
+	switch (path)
+	{
+	case SimdScalar:
+		return true;
+	case SimdSSE2:
+#ifdef SIMD_SSE2
+		return true;
+#else
+		return false;
+#endif
+	case SimdAVX2:
+		return simdAvx2Built && cpu_has_avx2();
+	default:
+		return false;
+	}
+}
+
+static int fastest_path()
+{
+	for (int path = SimdPathCount - 1; path > SimdScalar; path--)
+	{
+		if (simd_path_supported(path))
+		{
+			return path;
+		}
+	}
+	return SimdScalar;
+}
+
+// The path in use. A function-local static is initialised exactly once even
+// when the collision workers make the first call together.
+static int &selected_path()
+{
+	static int path = fastest_path();
+	return path;
+}
+
+int simd_path()
+{
+	return selected_path();
+}
+
+// Not synchronised with simd_path(): call it before any worker runs a kernel.
+bool set_simd_path(int path)
+{
+	if (!simd_path_supported(path))
+	{
+		return false;
+	}
+	selected_path() = path;
+	return true;
+}
+
+const char *simd_path_name(int path)
+{
+	switch (path)
+	{
+	case SimdScalar:
+		return "scalar";
+	case SimdSSE2:
+		return "sse2";
+	case SimdAVX2:
+		return "avx2";
+	default:
+		return "unknown";
+	}
+}
@@ -0,0 +1,22 @@
+#pragma once
+
+// SSE2 is part of x86-64 and of 32-bit builds made with -msse2 or /arch:SSE2
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define SIMD_SSE2 1
+#endif
+
+// Which instruction set the vectorized kernels (Integrate, NarrowPhase) run
+// with. The fastest one the CPU supports is picked on first use;
+// set_simd_path() overrides it, e.g. to compare paths in a benchmark.
+enum SimdPath
+{
+	SimdScalar,
+	SimdSSE2,
+	SimdAVX2,
+	SimdPathCount
+};
+
+int simd_path();
+bool simd_path_supported(int);
+bool set_simd_path(int);
+const char *simd_path_name(int);
@@ -0,0 +1,128 @@
+#include "SoundPool.h"
+
+SoundPool::SoundPool()
+{
+	this->pending.reserve(SOUND_STARTS_PER_UPDATE);
+	this->now = 0;
+}
+
+// Adds an effect playing buffer on voiceCount voices of its own and returns
+// its id. Meant for startup only: the voices must not move once playing.
+int SoundPool::addEffect(const SoundBuffer &buffer, int voiceCount, float minInterval, int priority)
+{
+	Effect effect = { (int)this->voices.size(), voiceCount, minInterval, priority, -minInterval, false };
+	for (int v = 0; v < voiceCount; v++)
+	{
+		this->voices.push_back(Sound(buffer));
+		this->voiceStarted.push_back(0);
+	}
+	this->effects.push_back(effect);
+	return (int)this->effects.size() - 1;
+}
+
+// Asks for effect to start at the next update(). Dropped if the effect was
+// started less than its interval ago or the queue is full and this request
+// ranks lowest. Only a request that gets queued counts towards the interval.
+void SoundPool::play(int effect, float pitch)
+{
+	Effect &target = this->effects[effect];
+	if (this->now - target.lastStart < target.minInterval)
+	{
+		return;
+	}
+
+	Request request = { effect, pitch };
+	if (this->pending.size() < SOUND_STARTS_PER_UPDATE)
+	{
+		this->pending.push_back(request);
+		target.lastStart = this->now;
+		return;
+	}
+
+	// full: replace the lowest-priority request if this one ranks higher
+	size_t lowest = 0;
+	for (size_t r = 1; r < this->pending.size(); r++)
+	{
+		if (this->effects[this->pending[r].effect].priority < this->effects[this->pending[lowest].effect].priority)
+		{
+			lowest = r;
+		}
+	}
+	if (this->effects[this->pending[lowest].effect].priority < target.priority)
+	{
+		this->pending[lowest] = request;
+		target.lastStart = this->now;
+	}
+}
+
+// Starts or stops a looped effect on its first voice.
+void SoundPool::setLooping(int effect, bool on)
+{
+	Effect &target = this->effects[effect];
+	if (target.looping == on)
+	{
+		return;
+	}
+	target.looping = on;
+
+	Sound &voice = this->voices[target.firstVoice];
+	if (on)
+	{
+		voice.setLoop(true);
+		voice.play();
+	}
+	else
+	{
+		voice.stop();
+	}
+}
+
+// A stopped voice of the effect, or failing that the one playing longest.
+int SoundPool::pickVoice(const Effect &effect) const
+{
+	int oldest = effect.firstVoice;
+	for (int v = effect.firstVoice; v < effect.firstVoice + effect.voiceCount; v++)
+	{
+		if (this->voices[v].getStatus() == SoundSource::Stopped)
+		{
+			return v;
+		}
+		if (this->voiceStarted[v] < this->voiceStarted[oldest])
+		{
+			oldest = v;
+		}
+	}
+	return oldest;
+}
+
+// Advances the pool's clock by elapsed seconds and starts the queued sounds.
+void SoundPool::update(float elapsed)
+{
+	this->now += elapsed;
+
+	// highest priority first; the queue is a handful of entries
+	for (size_t i = 1; i < this->pending.size(); i++)
+	{
+		Request request = this->pending[i];
+		size_t j = i;
+		while (j > 0 && this->effects[this->pending[j - 1].effect].priority < this->effects[request.effect].priority)
+		{
+			this->pending[j] = this->pending[j - 1];
+			j--;
+		}
+		this->pending[j] = request;
+	}
+
+	for (size_t r = 0; r < this->pending.size(); r++)
+	{
+		int v = this->pickVoice(this->effects[this->pending[r].effect]);
+		this->voices[v].setPitch(this->pending[r].pitch);
+		this->voices[v].play();
+		this->voiceStarted[v] = this->now;
+	}
+	this->pending.clear();
+}
+
+SoundPool::~SoundPool()
+{
+}
@@ -0,0 +1,54 @@
+#pragma once
+#include <SFML/Audio.hpp>
+#include <cstddef>
+#include <vector>
+
+using namespace sf;
+
+// most sounds started in one update(), over all effects
+const int SOUND_STARTS_PER_UPDATE = 8;
+
+// A fixed set of voices for each sound effect. play() only queues a request;
+// update() starts the queued ones once a frame, highest priority first and
+// at most SOUND_STARTS_PER_UPDATE of them, so a frame full of explosions
+// costs the same handful of audio calls as a quiet one. An effect retriggered
+// faster than its minimum interval is ignored, and when all its voices are
+// busy the one that started longest ago is cut off and reused.
+//
+// Looped effects (the drift hum) are switched with setLooping(), which only
+// touches the voice when the state actually changes.
+class SoundPool
+{
+private:
+	struct Effect
+	{
+		int firstVoice;
+		int voiceCount;
+		float minInterval;
+		int priority;
+		float lastStart;
+		bool looping;
+	};
+
+	struct Request
+	{
+		int effect;
+		float pitch;
+	};
+
+	std::vector<Sound> voices;
+	std::vector<float> voiceStarted;
+	std::vector<Effect> effects;
+	std::vector<Request> pending;
+	float now;
+
+	int pickVoice(const Effect &) const;
+
+public:
+	SoundPool();
+	int addEffect(const SoundBuffer &, int, float, int);
+	void play(int, float);
+	void setLooping(int, bool);
+	void update(float);
+	~SoundPool();
+};
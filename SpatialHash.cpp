@@ -0,0 +1,76 @@
+#include "SpatialHash.h"
+
+#include <algorithm>
+#include <cmath>
+
+SpatialHash::SpatialHash(float width, float height, float cellSize)
+{
+	this->width = width;
+	this->height = height;
+	this->setCellSize(cellSize);
+}
+
+void SpatialHash::setCellSize(float newSize)
+{
+	this->cellSize = newSize;
+	this->cols = (int)std::ceil(this->width / newSize);
+	this->rows = (int)std::ceil(this->height / newSize);
+	if (this->cols < 1)
+	{
+		this->cols = 1;
+	}
+	if (this->rows < 1)
+	{
+		this->rows = 1;
+	}
+
+	this->cellStart.assign(this->cols * this->rows + 1, 0);
+	this->cellCursor.assign(this->cols * this->rows, 0);
+}
+
+float SpatialHash::getCellSize() const
+{
+	return this->cellSize;
+}
+
+int SpatialHash::wrap(int value, int count) const
+{
+	value %= count;
+	return value < 0 ? value + count : value;
+}
+
+int SpatialHash::cellCoord(float value) const
+{
+	return (int)std::floor(value / this->cellSize);
+}
+
+void SpatialHash::build(const float *xs, const float *ys, size_t count)
+{
+	int cellCount = this->cols * this->rows;
+
+	this->itemCell.resize(count);
+	this->cellItems.resize(count);
+	std::fill(this->cellStart.begin(), this->cellStart.end(), 0);
+
+	for (size_t i = 0; i < count; i++)
+	{
+		int cell = this->wrap(this->cellCoord(ys[i]), this->rows) * this->cols + this->wrap(this->cellCoord(xs[i]), this->cols);
+		this->itemCell[i] = cell;
+		this->cellStart[cell + 1]++;
+	}
+
+	for (int c = 0; c < cellCount; c++)
+	{
+		this->cellStart[c + 1] += this->cellStart[c];
+		this->cellCursor[c] = this->cellStart[c];
+	}
+
+	for (size_t i = 0; i < count; i++)
+	{
+		this->cellItems[this->cellCursor[this->itemCell[i]]++] = (int)i;
+	}
+}
+
+SpatialHash::~SpatialHash()
+{
+}
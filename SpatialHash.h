@@ -0,0 +1,67 @@
+#pragma once
+#include <vector>
+#include <cstddef>
+
+// Uniform grid broadphase over the playfield. Cells wrap around the edges the
+// same way objects wrap around the screen, so anything near one border is
+// still a neighbour of whatever sits next to the opposite border.
+//
+// The cell size has to be at least twice the largest radius that is stored or
+// queried; then every possible overlap lies inside the 3x3 block of cells
+// around the query point.
+class SpatialHash
+{
+private:
+	float width;
+	float height;
+	float cellSize;
+	int cols;
+	int rows;
+
+	// counting-sort layout: the items of cell c are
+	// cellItems[cellStart[c] .. cellStart[c + 1])
+	std::vector<int> cellStart;
+	std::vector<int> cellCursor;
+	std::vector<int> cellItems;
+	std::vector<int> itemCell;
+
+	int wrap(int, int) const;
+	int cellCoord(float) const;
+
+public:
+	SpatialHash(float, float, float);
+	void setCellSize(float);
+	float getCellSize() const;
+	void build(const float *, const float *, size_t);
+	template <typename Visit> void query(float, float, Visit) const;
+	~SpatialHash();
+};
+
+// Calls visit(index) for every stored item in the 3x3 block of cells around
+// (x, y). Each item is reported at most once, in ascending cell order.
+template <typename Visit>
+void SpatialHash::query(float x, float y, Visit visit) const
+{
+	int col = this->cellCoord(x);
+	int row = this->cellCoord(y);
+
+	// with fewer than three cells along an axis the wrapped neighbours would
+	// repeat, so just scan the whole axis
+	int colCount = this->cols < 3 ? this->cols : 3;
+	int rowCount = this->rows < 3 ? this->rows : 3;
+	int firstCol = this->cols < 3 ? 0 : col - 1;
+	int firstRow = this->rows < 3 ? 0 : row - 1;
+
+	for (int r = 0; r < rowCount; r++)
+	{
+		int cellRow = this->wrap(firstRow + r, this->rows) * this->cols;
+		for (int c = 0; c < colCount; c++)
+		{
+			int cell = cellRow + this->wrap(firstCol + c, this->cols);
+			for (int k = this->cellStart[cell]; k < this->cellStart[cell + 1]; k++)
+			{
+				visit(this->cellItems[k]);
+			}
+		}
+	}
+}
@@ -0,0 +1,136 @@
+#include "SweepAndPrune.h"
+
+#include <algorithm>
+
+SweepAndPrune::SweepAndPrune()
+{
+	this->maxRadius = 0.f;
+	this->swaps = 0;
+	this->fullSort = false;
+}
+
+// First slot whose minX is not below value.
+size_t SweepAndPrune::firstSlot(float value) const
+{
+	return std::lower_bound(this->minX.begin(), this->minX.end(), value) - this->minX.begin();
+}
+
+// Re-sorts the circles for this tick. ids are the store's EntityStore::id
+// column: entities still there since the last build keep their slot, whatever
+// index compaction moved them to, and new ones are appended.
+void SweepAndPrune::build(const float *xs, const float *ys, const float *radii, const unsigned *ids, size_t count)
+{
+	size_t previous = this->ids.size();
+
+	// both id lists ascend, so one merge maps every old index to its new one
+	this->remap.resize(previous);
+	size_t n = 0;
+	for (size_t o = 0; o < previous; o++)
+	{
+		while (n < count && ids[n] < this->ids[o])
+		{
+			n++;
+		}
+		this->remap[o] = n < count && ids[n] == this->ids[o] ? (int)n : -1;
+	}
+
+	// drop the entities that are gone and append the new ones, which keeps
+	// order a permutation of [0, count)
+	this->placed.assign(count, 0);
+	size_t kept = 0;
+	for (size_t s = 0; s < this->order.size(); s++)
+	{
+		int i = this->remap[this->order[s]];
+		if (i >= 0)
+		{
+			this->order[kept++] = i;
+			this->placed[i] = 1;
+		}
+	}
+	this->order.resize(kept);
+	for (size_t i = 0; i < count; i++)
+	{
+		if (!this->placed[i])
+		{
+			this->order.push_back((int)i);
+		}
+	}
+	this->ids.assign(ids, ids + count);
+
+	this->minX.resize(count);
+	this->maxRadius = 0.f;
+	for (size_t s = 0; s < count; s++)
+	{
+		int i = this->order[s];
+		this->minX[s] = xs[i] - (radii[i] + SWEEP_PADDING);
+		this->maxRadius = std::max(this->maxRadius, radii[i] + SWEEP_PADDING);
+	}
+
+	// insertion sort while the old order is a good guess, a full sort otherwise
+	size_t budget = 8 * count;
+	this->swaps = 0;
+	bool sorted = kept >= count - count / 8;
+	for (size_t s = 1; sorted && s < count; s++)
+	{
+		float key = this->minX[s];
+		int item = this->order[s];
+		size_t t = s;
+		for (; t > 0 && this->minX[t - 1] > key; t--)
+		{
+			this->minX[t] = this->minX[t - 1];
+			this->order[t] = this->order[t - 1];
+		}
+		this->minX[t] = key;
+		this->order[t] = item;
+
+		this->swaps += s - t;
+		if (this->swaps > budget)
+		{
+			sorted = false;
+		}
+	}
+
+	this->fullSort = !sorted;
+	if (!sorted)
+	{
+		std::sort(this->order.begin(), this->order.end(), [&](int a, int b)
+		{
+			float keyA = xs[a] - (radii[a] + SWEEP_PADDING);
+			float keyB = xs[b] - (radii[b] + SWEEP_PADDING);
+			return keyA < keyB || (keyA == keyB && a < b);
+		});
+		for (size_t s = 0; s < count; s++)
+		{
+			int i = this->order[s];
+			this->minX[s] = xs[i] - (radii[i] + SWEEP_PADDING);
+		}
+	}
+
+	this->maxX.resize(count);
+	this->minY.resize(count);
+	this->maxY.resize(count);
+	for (size_t s = 0; s < count; s++)
+	{
+		int i = this->order[s];
+		float radius = radii[i] + SWEEP_PADDING;
+		this->maxX[s] = xs[i] + radius;
+		this->minY[s] = ys[i] - radius;
+		this->maxY[s] = ys[i] + radius;
+	}
+}
+
+// How many slot moves the insertion sort made in the last build().
+size_t SweepAndPrune::getLastSwaps() const
+{
+	return this->swaps;
+}
+
+// Whether the last build() gave up on the previous order and sorted from scratch.
+bool SweepAndPrune::wasFullSort() const
+{
+	return this->fullSort;
+}
+
+SweepAndPrune::~SweepAndPrune()
+{
+}
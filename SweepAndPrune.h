@@ -0,0 +1,102 @@
+#pragma once
+#include <vector>
+#include <cstddef>
+
+const float SWEEP_PADDING = 1.f;
+
+// Sweep-and-prune broadphase: the circles' x extents are kept sorted by their
+// left edge, and only circles whose x and y extents both overlap are reported.
+// The order from the previous build() is kept and repaired with an insertion
+// sort, which is close to linear while things move only a little per tick;
+// after big changes (a new wave, a first build) it falls back to a full sort.
+// The previous order is carried over by EntityStore::id, so compaction moving
+// entities to new indices does not scramble it.
+//
+// The extents use the raw, unwrapped coordinates. The narrow phase measures
+// plain screen distance as well, so something hanging over one edge is only
+// ever tested where it actually is, and the seam needs no ghost copies.
+//
+// Every extent is padded by a pixel, so float rounding in the extents can never
+// drop a pair the narrow phase would count as touching.
+class SweepAndPrune
+{
+private:
+	// entity index per slot, sorted by minX; the other columns follow the same order
+	std::vector<int> order;
+	std::vector<float> minX;
+	std::vector<float> maxX;
+	std::vector<float> minY;
+	std::vector<float> maxY;
+	float maxRadius;
+	size_t swaps;
+	bool fullSort;
+	// store ids at the last build, by entity index, and scratch for mapping
+	// last build's indices to this one's
+	std::vector<unsigned> ids;
+	std::vector<int> remap;
+	std::vector<unsigned char> placed;
+
+	size_t firstSlot(float) const;
+
+public:
+	SweepAndPrune();
+	void build(const float *, const float *, const float *, const unsigned *, size_t);
+	size_t getLastSwaps() const;
+	bool wasFullSort() const;
+	template <typename Visit> void query(float, float, float, Visit) const;
+	template <typename Visit> void sweep(Visit) const;
+	template <typename Visit> void sweepAgainst(const SweepAndPrune &, Visit) const;
+	~SweepAndPrune();
+};
+
+// Calls visit(index) for every circle whose bounds overlap those of the circle
+// at (x, y) with the given radius.
+template <typename Visit>
+void SweepAndPrune::query(float x, float y, float radius, Visit visit) const
+{
+	radius += SWEEP_PADDING;
+
+	// nothing that starts left of here can reach x - radius
+	for (size_t s = this->firstSlot(x - radius - 2 * this->maxRadius); s < this->order.size() && this->minX[s] <= x + radius; s++)
+	{
+		if (this->maxX[s] >= x - radius && this->minY[s] <= y + radius && this->maxY[s] >= y - radius)
+		{
+			visit(this->order[s]);
+		}
+	}
+}
+
+// Calls visit(a, b) once for every overlapping pair of stored circles.
+template <typename Visit>
+void SweepAndPrune::sweep(Visit visit) const
+{
+	size_t count = this->order.size();
+	for (size_t a = 0; a < count; a++)
+	{
+		for (size_t b = a + 1; b < count && this->minX[b] <= this->maxX[a]; b++)
+		{
+			if (this->minY[b] <= this->maxY[a] && this->maxY[b] >= this->minY[a])
+			{
+				visit(this->order[a], this->order[b]);
+			}
+		}
+	}
+}
+
+// Calls visit(mine, theirs) for every circle here overlapping one in other.
+template <typename Visit>
+void SweepAndPrune::sweepAgainst(const SweepAndPrune &other, Visit visit) const
+{
+	size_t count = this->order.size();
+	size_t otherCount = other.order.size();
+	for (size_t a = 0; a < count; a++)
+	{
+		for (size_t b = other.firstSlot(this->minX[a] - 2 * other.maxRadius); b < otherCount && other.minX[b] <= this->maxX[a]; b++)
+		{
+			if (other.maxX[b] >= this->minX[a] && other.minY[b] <= this->maxY[a] && other.maxY[b] >= this->minY[a])
+			{
+				visit(this->order[a], other.order[b]);
+			}
+		}
+	}
+}
@@ -0,0 +1,107 @@
+#include "TextureAtlas.h"
+
+#include <algorithm>
+
+TextureAtlas::TextureAtlas()
+{
+	// empty pixels between regions so smoothing never samples a neighbour
+	this->padding = 2;
+}
+
+// Queues a whole image as one region; it is copied.
+int TextureAtlas::add(const Image &image)
+{
+	this->images.push_back(image);
+
+	Vector2u size = this->images.back().getSize();
+	Item item = { this->images.size() - 1, IntRect(0, 0, size.x, size.y) };
+	this->items.push_back(item);
+	this->regions.push_back(IntRect());
+
+	return (int)this->items.size() - 1;
+}
+
+// Queues count frames of frameWidth x frameHeight read row by row from a
+// sprite sheet. Returns the region index of the first frame.
+int TextureAtlas::addFrames(const Image &image, int frameWidth, int frameHeight, int count)
+{
+	this->images.push_back(image);
+
+	int columns = std::max(1, (int)this->images.back().getSize().x / frameWidth);
+	int first = (int)this->items.size();
+	for (int i = 0; i < count; i++)
+	{
+		Item item = { this->images.size() - 1, IntRect(i % columns * frameWidth, i / columns * frameHeight, frameWidth, frameHeight) };
+		this->items.push_back(item);
+		this->regions.push_back(IntRect());
+	}
+
+	return first;
+}
+
+// Packs everything queued so far into a texture of the given width and
+// uploads it. The source images are released afterwards. Fails if the
+// result does not fit the GPU's texture size limit.
+bool TextureAtlas::build(unsigned width)
+{
+	std::vector<size_t> order(this->items.size());
+	for (size_t i = 0; i < order.size(); i++)
+	{
+		order[i] = i;
+	}
+	std::stable_sort(order.begin(), order.end(), [this](size_t a, size_t b)
+	{
+		return this->items[a].source.height > this->items[b].source.height;
+	});
+
+	unsigned x = 0, y = 0, shelfHeight = 0;
+	for (size_t i = 0; i < order.size(); i++)
+	{
+		const IntRect &source = this->items[order[i]].source;
+		unsigned w = source.width + this->padding;
+		unsigned h = source.height + this->padding;
+
+		if (x > 0 && x + w > width)
+		{
+			y += shelfHeight;
+			x = 0;
+			shelfHeight = 0;
+		}
+
+		this->regions[order[i]] = IntRect(x, y, source.width, source.height);
+		x += w;
+		shelfHeight = std::max(shelfHeight, h);
+	}
+	unsigned height = y + shelfHeight;
+
+	unsigned maxSize = Texture::getMaximumSize();
+	if (width > maxSize || height > maxSize)
+	{
+		return false;
+	}
+
+	Image atlas;
+	atlas.create(width, height, Color::Transparent);
+	for (size_t i = 0; i < this->items.size(); i++)
+	{
+		const IntRect &region = this->regions[i];
+		atlas.copy(this->images[this->items[i].image], region.left, region.top, this->items[i].source);
+	}
+
+	this->images.clear();
+	return this->texture.loadFromImage(atlas);
+}
+
+const Texture &TextureAtlas::getTexture() const
+{
+	return this->texture;
+}
+
+const IntRect &TextureAtlas::getRegion(int index) const
+{
+	return this->regions[index];
+}
+
+TextureAtlas::~TextureAtlas()
+{
+}
@@ -0,0 +1,36 @@
+#pragma once
+#include <SFML/Graphics.hpp>
+#include <cstddef>
+#include <vector>
+
+using namespace sf;
+
+// Packs several images into one texture at startup so everything drawn from it
+// can share a draw call. Images are queued with add()/addFrames(), which return
+// a region index, and build() packs them onto shelves, tallest first. The
+// frames of an animation strip get consecutive region indices, so frame n of a
+// strip is getRegion(first + n).
+class TextureAtlas
+{
+private:
+	struct Item
+	{
+		size_t image;
+		IntRect source;
+	};
+
+	Texture texture;
+	std::vector<Image> images;
+	std::vector<Item> items;
+	std::vector<IntRect> regions;
+	unsigned padding;
+
+public:
+	TextureAtlas();
+	int add(const Image &);
+	int addFrames(const Image &, int, int, int);
+	bool build(unsigned);
+	const Texture &getTexture() const;
+	const IntRect &getRegion(int) const;
+	~TextureAtlas();
+};
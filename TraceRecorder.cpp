@@ -0,0 +1,112 @@
+#include "TraceRecorder.h"
+
+#include <cstdio>
+
+TraceRecorder tracer;
+
+TraceRecorder::TraceRecorder()
+{
+	this->epoch = Clock::now();
+}
+
+// The calling thread's ring, created on its first event.
+TraceRecorder::Ring &TraceRecorder::ring()
+{
+	thread_local Ring *mine = nullptr;
+	if (!mine)
+	{
+		std::lock_guard<std::mutex> guard(this->lock);
+		std::unique_ptr<Ring> ring(new Ring());
+		ring->events.resize(TRACE_RING_EVENTS);
+		ring->written = 0;
+		ring->thread = (int)this->rings.size();
+		mine = ring.get();
+		this->rings.push_back(std::move(ring));
+	}
+	return *mine;
+}
+
+void TraceRecorder::record(const char *name, char phase)
+{
+	Ring &ring = this->ring();
+	size_t slot = ring.written.load(std::memory_order_relaxed);
+
+	TraceEvent &event = ring.events[slot % TRACE_RING_EVENTS];
+	event.name = name;
+	event.time = std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - this->epoch).count();
+	event.phase = phase;
+
+	ring.written.store(slot + 1, std::memory_order_release);
+}
+
+// Writes everything still in the rings to path. A ring that wrapped starts
+// partway through a span, so end events without their begin are skipped.
+// Returns false if the file cannot be opened.
+bool TraceRecorder::write(const char *path)
+{
+	FILE *file = std::fopen(path, "w");
+	if (!file)
+	{
+		return false;
+	}
+
+	std::lock_guard<std::mutex> guard(this->lock);
+	std::fprintf(file, "{\"traceEvents\":[\n");
+
+	bool first = true;
+	for (size_t r = 0; r < this->rings.size(); r++)
+	{
+		const Ring &ring = *this->rings[r];
+		size_t written = ring.written.load(std::memory_order_acquire);
+		size_t begin = written > TRACE_RING_EVENTS ? written - TRACE_RING_EVENTS : 0;
+
+		std::fprintf(file, "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%d,\"args\":{\"name\":\"thread %d\"}}",
+			first ? "" : ",\n", ring.thread, ring.thread);
+		first = false;
+
+		int depth = 0;
+		for (size_t i = begin; i < written; i++)
+		{
+			const TraceEvent &event = ring.events[i % TRACE_RING_EVENTS];
+			if (event.phase == 'E' && depth == 0)
+			{
+				continue;
+			}
+			depth += event.phase == 'B' ? 1 : event.phase == 'E' ? -1 : 0;
+
+			std::fprintf(file, ",\n{\"name\":\"%s\",\"ph\":\"%c\",\"ts\":%.3f,\"pid\":1,\"tid\":%d%s}",
+				event.name, event.phase, event.time / 1000.0, ring.thread, event.phase == 'i' ? ",\"s\":\"t\"" : "");
+		}
+	}
+
+	std::fprintf(file, "\n]}\n");
+	std::fclose(file);
+	return true;
+}
+
+// Forgets every recorded event; the rings themselves are kept. Same rule as
+// write() about other threads.
+void TraceRecorder::clear()
+{
+	std::lock_guard<std::mutex> guard(this->lock);
+	for (size_t r = 0; r < this->rings.size(); r++)
+	{
+		this->rings[r]->written.store(0, std::memory_order_relaxed);
+	}
+}
+
+TraceRecorder::~TraceRecorder()
+{
+}
+
+TraceRecorder::Span::Span(TraceRecorder &recorder, const char *name)
+	: recorder(recorder)
+{
+	this->name = name;
+	this->recorder.record(name, 'B');
+}
+
+TraceRecorder::Span::~Span()
+{
+	this->recorder.record(this->name, 'E');
+}
@@ -0,0 +1,80 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+// events kept per thread; older ones are overwritten
+const size_t TRACE_RING_EVENTS = 1 << 16;
+
+// One begin, end or instant event. Names must be string literals (or live as
+// long as the program): only the pointer is stored.
+struct TraceEvent
+{
+	const char *name;
+	long long time;  // nanoseconds since the recorder was created
+	char phase;      // 'B', 'E' or 'i', as in the Chrome trace format
+};
+
+// Records timeline events from any thread into a ring buffer per thread and
+// writes them out as Chrome trace JSON, which Perfetto and chrome://tracing
+// open directly. Recording takes no lock: a thread only ever writes its own
+// ring, and the lock is taken once per thread, when its ring is created.
+//
+// write() reads every ring, so it must run while no other thread is
+// recording. Between frames that always holds: the worker pool only runs
+// inside ck_optimize().
+class TraceRecorder
+{
+private:
+	typedef std::chrono::steady_clock Clock;
+
+	struct Ring
+	{
+		std::vector<TraceEvent> events;
+		std::atomic<size_t> written;
+		int thread;
+	};
+
+	Clock::time_point epoch;
+	std::mutex lock;
+	// rings outlive their threads, so a worker pool that is rebuilt keeps its history
+	std::vector<std::unique_ptr<Ring>> rings;
+
+	Ring &ring();
+
+public:
+	TraceRecorder();
+	void record(const char *, char);
+	bool write(const char *);
+	void clear();
+	~TraceRecorder();
+
+	// Records a begin event now and the matching end when it goes out of scope.
+	class Span
+	{
+	private:
+		TraceRecorder &recorder;
+		const char *name;
+
+	public:
+		Span(TraceRecorder &, const char *);
+		~Span();
+	};
+};
+
+// the one the TRACE_ macros feed
+extern TraceRecorder tracer;
+
+// Like the PROFILE_ macros, these are empty unless ASTEROID_PROFILE is defined.
+#ifdef ASTEROID_PROFILE
+#define TRACE_JOIN2(a, b) a##b
+#define TRACE_JOIN(a, b) TRACE_JOIN2(a, b)
+#define TRACE_SCOPE(name) TraceRecorder::Span TRACE_JOIN(traceSpan, __LINE__)(tracer, name)
+#define TRACE_INSTANT(name) tracer.record(name, 'i')
+#else
+#define TRACE_SCOPE(name) ((void)0)
+#define TRACE_INSTANT(name) ((void)0)
+#endif
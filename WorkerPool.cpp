@@ -0,0 +1,137 @@
+#include "WorkerPool.h"
+
+// threadCount includes the thread that calls run(), so 1 means no extra threads.
+WorkerPool::WorkerPool(int threadCount)
+	: pending(0)
+{
+	this->job = nullptr;
+	this->generation = 0;
+	this->stopping = false;
+
+	if (threadCount < 1)
+	{
+		threadCount = 1;
+	}
+	for (int i = 0; i < threadCount; i++)
+	{
+		this->queues.push_back(std::unique_ptr<Queue>(new Queue()));
+	}
+	for (int i = 1; i < threadCount; i++)
+	{
+		this->threads.push_back(std::thread(&WorkerPool::workerMain, this, i));
+	}
+}
+
+int WorkerPool::getThreadCount() const
+{
+	return (int)this->queues.size();
+}
+
+// Takes the next task from the worker's own queue, or steals the last one of
+// another worker's queue. Returns false when there is nothing left anywhere.
+bool WorkerPool::nextTask(int worker, int &task)
+{
+	int count = (int)this->queues.size();
+	for (int k = 0; k < count; k++)
+	{
+		Queue &queue = *this->queues[(worker + k) % count];
+		std::lock_guard<std::mutex> guard(queue.lock);
+		if (queue.tasks.empty())
+		{
+			continue;
+		}
+
+		if (k == 0)
+		{
+			task = queue.tasks.front();
+			queue.tasks.pop_front();
+		}
+		else
+		{
+			task = queue.tasks.back();
+			queue.tasks.pop_back();
+		}
+		return true;
+	}
+	return false;
+}
+
+void WorkerPool::work(int worker)
+{
+	int task;
+	while (this->nextTask(worker, task))
+	{
+		(*this->job)(task);
+
+		if (this->pending.fetch_sub(1) == 1)
+		{
+			std::lock_guard<std::mutex> guard(this->lock);
+			this->done.notify_all();
+		}
+	}
+}
+
+void WorkerPool::workerMain(int worker)
+{
+	unsigned seen = 0;
+	for (;;)
+	{
+		{
+			std::unique_lock<std::mutex> guard(this->lock);
+			this->wake.wait(guard, [&] { return this->stopping || this->generation != seen; });
+			if (this->stopping)
+			{
+				return;
+			}
+			seen = this->generation;
+		}
+		this->work(worker);
+	}
+}
+
+void WorkerPool::run(int count, const std::function<void(int)> &task)
+{
+	if (this->threads.empty() || count <= 1)
+	{
+		for (int i = 0; i < count; i++)
+		{
+			task(i);
+		}
+		return;
+	}
+
+	this->job = &task;
+	this->pending.store(count);
+	for (int i = 0; i < count; i++)
+	{
+		Queue &queue = *this->queues[i % this->queues.size()];
+		std::lock_guard<std::mutex> guard(queue.lock);
+		queue.tasks.push_back(i);
+	}
+
+	{
+		std::lock_guard<std::mutex> guard(this->lock);
+		this->generation++;
+	}
+	this->wake.notify_all();
+
+	this->work(0);
+
+	std::unique_lock<std::mutex> guard(this->lock);
+	this->done.wait(guard, [&] { return this->pending.load() == 0; });
+	this->job = nullptr;
+}
+
+WorkerPool::~WorkerPool()
+{
+	{
+		std::lock_guard<std::mutex> guard(this->lock);
+		this->stopping = true;
+	}
+	this->wake.notify_all();
+
+	for (size_t i = 0; i < this->threads.size(); i++)
+	{
+		this->threads[i].join();
+	}
+}
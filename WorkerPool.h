@@ -0,0 +1,48 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// A fixed set of worker threads for splitting one job into many tasks.
+// run(count, task) calls task(index) once for every index in [0, count) and
+// returns when all of them are done; the calling thread works as well. Task
+// indices are dealt out round-robin to per-worker queues, and a worker whose
+// queue is empty steals from the back of the others, so uneven tasks still
+// keep every thread busy. Which thread runs which task is not fixed, so tasks
+// must write only to their own output.
+class WorkerPool
+{
+private:
+	struct Queue
+	{
+		std::mutex lock;
+		std::deque<int> tasks;
+	};
+
+	std::vector<std::thread> threads;
+	// one per worker; queue 0 belongs to the thread calling run()
+	std::vector<std::unique_ptr<Queue>> queues;
+	const std::function<void(int)> *job;
+	std::atomic<int> pending;
+
+	std::mutex lock;
+	std::condition_variable wake;
+	std::condition_variable done;
+	unsigned generation;
+	bool stopping;
+
+	bool nextTask(int, int &);
+	void work(int);
+	void workerMain(int);
+
+public:
+	WorkerPool(int);
+	int getThreadCount() const;
+	void run(int, const std::function<void(int)> &);
+	~WorkerPool();
+};
@@ -0,0 +1,940 @@
+#include "World.h"
+
+#include "Integrate.h"
+#include "TraceRecorder.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <functional>
+#include <thread>
+
+// asteroids per collision task; small enough to balance, big enough that the
+// per-task overhead does not show
+const int COLLISION_CHUNK = 256;
+
+// the grid cell size is a whole number of these, in pixels
+const float CELL_STEP = 8.f;
+
+// what a hit asteroid breaks into; KindCount means it is destroyed
+const unsigned char SPLITS_INTO[] = { KindCount, KindSmallAst, KindMediumAst };
+
+static constexpr bool is_asteroid(int kind)
+{
+	return kind == KindSmallAst || kind == KindMediumAst || kind == KindBigAst;
+}
+
+// The first kind is the one doing the sweep: an asteroid for asteroid and
+// bullet contacts, the ship for crashes.
+constexpr World::ContactHandler World::contactRule(int first, int second)
+{
+	return is_asteroid(first) && is_asteroid(second) ? &World::bounceContact
+		: is_asteroid(first) && second == KindBullet ? &World::bulletContact
+		: first == KindShip && is_asteroid(second) ? &World::crashContact
+		: nullptr;
+}
+
+template <size_t... Pair>
+constexpr World::ContactTable World::makeContactTable(std::index_sequence<Pair...>)
+{
+	return { { contactRule(Pair / KindCount, Pair % KindCount)... } };
+}
+
+const World::ContactTable World::contactTable = World::makeContactTable(std::make_index_sequence<KindCount * KindCount>());
+
+World::World()
+	: astHash(GAMEWIDTH, GAMEHEIGHT, 2 * 85.f),
+	bulletHash(GAMEWIDTH, GAMEHEIGHT, 2 * 85.f)
+{
+	this->bulletVelocity = 500.f;
+	this->shipRadius = 55.f;
+	this->bulletRadius = 15.f;
+	this->bulletLifetime = 3.f;
+	this->shipVelocity = 500.f;
+	this->speedInterval = 4.f;
+	this->astroidVelocity = 250.f;
+	this->sAstRadius = 35.f;
+	this->mAstRadius = 55.f;
+	this->bAstRadius = 85.f;
+	this->asteroidsPerWave = 12;
+	this->collisionThreads = 0;
+	this->hardwareThreads = std::max(1, (int)std::thread::hardware_concurrency());
+	this->broadphase = BroadphaseGrid;
+
+	this->centreShip();
+	this->ship.rotation = 0.f;
+	this->ship.driftVelocity = 0.f;
+	this->ship.driftX = 0.f;
+	this->ship.driftY = 0.f;
+	this->ship.flashTimer = 100;
+	this->ship.shielded = false;
+
+	this->tick = 0;
+	this->score = 0;
+	this->life = 3;
+	this->level = 1;
+
+	this->seed(0);
+}
+
+// Seeds every random stream of the simulation from one session seed. Nothing
+// else in the world is random, so the seed and the inputs decide a session.
+void World::seed(unsigned seed)
+{
+	this->spawnRandom.seed(seed, RandomSpawn);
+	this->splitRandom.seed(seed, RandomSplit);
+}
+
+void World::moveShip(float dx, float dy)
+{
+	this->ship.x += dx;
+	this->ship.y += dy;
+}
+
+// Puts the ship back in the middle of the screen without interpolating the jump.
+void World::centreShip()
+{
+	this->ship.x = GAMEWIDTH / 2;
+	this->ship.y = GAMEHEIGHT / 2;
+	this->ship.prevX = this->ship.x;
+	this->ship.prevY = this->ship.y;
+}
+
+void World::emit(int type, float x, float y)
+{
+	WorldEvent event;
+	event.type = type;
+	event.x = x;
+	event.y = y;
+	this->events.push_back(event);
+}
+
+// One tick: player control first, then the rest of the simulation, in the
+// same order the game loop has always called them. The positions from before
+// the tick are kept for render interpolation.
+void World::step(const Input &input, float dt)
+{
+	this->events.clear();
+	this->ship.prevX = this->ship.x;
+	this->ship.prevY = this->ship.y;
+	this->asteroids.savePositions();
+	this->bullets.savePositions();
+	this->setControl(input, dt);
+	this->update_state(input, dt);
+}
+
+// Direction the held movement keys push the ship: one of eight, with both
+// components halved on a diagonal. Left wins over right and up over down,
+// except that right with both up and down held goes down, as the key checks
+// always did.
+// Wave sizes come from the command line and from recordings; create_ast()
+// sizes its scratch from them, so a negative or absurd one must not get that
+// far.
+bool valid_wave_size(int count)
+{
+	return count > 0 && count <= MAX_ASTEROIDS_PER_WAVE;
+}
+
+static void thrust_direction(const Input &input, float &x, float &y)
+{
+	bool up = input.held(ButtonUp);
+	bool down = input.held(ButtonDown);
+
+	x = input.held(ButtonLeft) ? -1.f : input.held(ButtonRight) ? 1.f : 0.f;
+	if (x > 0)
+	{
+		y = down ? 1.f : up ? -1.f : 0.f;
+	}
+	else
+	{
+		y = up ? -1.f : down ? 1.f : 0.f;
+	}
+
+	if (x != 0 && y != 0)
+	{
+		x *= 0.5f;
+		y *= 0.5f;
+	}
+}
+
+void World::setControl(const Input &input, float dt)
+{
+	PROFILE_SCOPE(ProfileSetControl);
+
+	float thrustX, thrustY;
+	thrust_direction(input, thrustX, thrustY);
+
+	Ship &ship = this->ship;
+	if (thrustX != 0 || thrustY != 0)
+	{
+		this->emit(EventDrift, ship.x, ship.y);
+		ship.driftX = thrustX;
+		ship.driftY = thrustY;
+		ship.driftVelocity = this->shipVelocity;
+	}
+	else
+	{
+		// coasting along the last thrust direction, slowing down every tick
+		this->emit(EventDriftStop, ship.x, ship.y);
+		if (ship.driftX != 0 || ship.driftY != 0)
+		{
+			if (ship.driftVelocity - this->speedInterval < 0)
+			{
+				ship.driftVelocity = 0;
+			}
+			ship.driftVelocity -= this->speedInterval;
+		}
+	}
+	this->moveShip(ship.driftX * ship.driftVelocity * dt, ship.driftY * ship.driftVelocity * dt);
+
+	if (input.held(ButtonFire))
+	{
+		this->shoot();
+	}
+}
+
+void World::update_state(const Input &input, float dt)
+{
+	PROFILE_SCOPE(ProfileUpdateState);
+
+	this->tick++;
+
+	if (input.held(ButtonInvincible))
+	{
+		this->make_it_invincible();
+	}
+
+	if (input.held(ButtonSkipLevel))
+	{
+		this->centreShip();
+		this->astroidVelocity += 100;
+		this->asteroids.clear();
+		this->bullets.clear();
+		this->create_ast();
+	}
+
+	float shipX = this->ship.x;
+	float shipY = this->ship.y;
+	float shipRadius = this->shipRadius;
+
+	// flip ship
+	if (shipY + shipRadius <= 0 && input.held(ButtonUp))
+	{
+		this->ship.y = GAMEHEIGHT - shipRadius;
+	}
+	else if (shipY + shipRadius >= GAMEHEIGHT && input.held(ButtonDown))
+	{
+		this->ship.y = -shipRadius;
+	}
+	else if (shipX + shipRadius <= 0 && input.held(ButtonLeft))
+	{
+		this->ship.x = GAMEWIDTH - shipRadius;
+	}
+	else if (shipX + shipRadius >= GAMEWIDTH && input.held(ButtonRight))
+	{
+		this->ship.x = -shipRadius;
+	}
+
+	float rotation = atan2(input.aimY - shipY, input.aimX - shipX) * 180 / PI;
+	this->ship.rotation = rotation + 90;
+
+	this->move_bullets(dt);
+	this->move_asteroids(dt);
+
+	this->ck_optimize();
+
+	if (this->asteroids.size() == 0)
+	{
+		this->levelUp();
+	}
+}
+
+// bulletLifetime in whole ticks of length dt
+unsigned World::bulletLifetimeTicks(float dt) const
+{
+	return (unsigned)std::lround(this->bulletLifetime / dt);
+}
+
+// bullets path: move and wrap, then drop the bullets that ran out of time.
+// Bullets are only appended and compact() keeps their order, so the store is
+// sorted by spawn tick and, as they all live equally long, the expired ones
+// are a prefix: the scan stops at the first bullet still in flight, and
+// removeFront() drops them without moving the rest.
+void World::move_bullets(float dt)
+{
+	EntityStore &bullets = this->bullets;
+	integrate_wrap(bullets, dt, GAMEWIDTH, GAMEHEIGHT, false);
+
+	unsigned lifetime = this->bulletLifetimeTicks(dt);
+	size_t expired = bullets.head;
+	while (expired < bullets.size() && this->tick - bullets.born[expired] >= lifetime)
+	{
+		expired++;
+	}
+	if (expired > bullets.head)
+	{
+		bullets.removeFront(expired - bullets.head);
+	}
+}
+
+// astroid path: wrap at the screen edges, then move
+void World::move_asteroids(float dt)
+{
+	integrate_wrap(this->asteroids, dt, GAMEWIDTH, GAMEHEIGHT, true);
+}
+
+void World::shoot()
+{
+	this->emit(EventShoot, this->ship.x, this->ship.y);
+
+	float rotation = this->ship.rotation * PI / 180;
+
+	size_t index = this->bullets.add(KindBullet,
+		this->ship.x + 80 * sin(rotation), this->ship.y - 80 * cos(rotation),
+		sin(rotation), -cos(rotation),
+		this->bulletVelocity, this->bulletRadius);
+	this->bullets.born[index] = this->tick;
+}
+
+void World::create_ast()
+{
+	int count = this->asteroidsPerWave;
+
+	// the whole wave's random numbers in three bulk draws; stress waves spawn
+	// thousands at once
+	this->spawnSizes.resize(count);
+	this->spawnAlong.resize(count);
+	this->spawnHeading.resize(count);
+	this->spawnRandom.fillBelow(this->spawnSizes.data(), count, 3);
+	this->spawnRandom.fillUniform(this->spawnAlong.data(), count, 0.f, 1.f);
+	this->spawnRandom.fillUniform(this->spawnHeading.data(), count, 0.f, 2 * PI);
+	this->asteroids.reserve(this->asteroids.size() + count);
+
+	for (int i = 0; i < count; i++)
+	{
+		// larger waves repeat the twelve spawn slots of the original layout
+		int slot = i % 12;
+
+		unsigned char kind = KindSmallAst;
+		float radius = this->sAstRadius;
+
+		switch (this->spawnSizes[i])
+		{
+		case 0:
+			kind = KindSmallAst;
+			radius = this->sAstRadius;
+			break;
+		case 1:
+			kind = KindMediumAst;
+			radius = this->mAstRadius;
+			break;
+		case 2:
+			kind = KindBigAst;
+			radius = this->bAstRadius;
+			break;
+		default:
+			break;
+		}
+
+		float along = this->spawnAlong[i];
+		float astX, astY;
+
+		if (slot < 3)
+		{
+			astX = along * GAMEWIDTH;
+			astY = 1;
+		}
+		else if (slot >= 3 && slot < 7)
+		{
+			astX = along * GAMEWIDTH;
+			astY = GAMEHEIGHT - 1;
+		}
+		else if (slot > 7 && slot < 10)
+		{
+			astX = 1;
+			astY = along * GAMEHEIGHT;
+		}
+		else
+		{
+			astX = GAMEWIDTH - 1;
+			astY = along * GAMEHEIGHT;
+		}
+
+		float heading = this->spawnHeading[i];
+		this->asteroids.add(kind, astX, astY, sin(heading), cos(heading), this->astroidVelocity, radius);
+	}
+}
+
+void World::ast_get_hit(int index)
+{
+	EntityStore &asteroids = this->asteroids;
+
+	this->emit(EventExplode, asteroids.x[index], asteroids.y[index]);
+
+	unsigned char smaller = SPLITS_INTO[asteroids.kind[index]];
+	if (smaller != KindCount)
+	{
+		float smallerRadius = smaller == KindMediumAst ? this->mAstRadius : this->sAstRadius;
+		// the two halves fly apart along a random line
+		float heading = this->splitRandom.angle();
+		float dirX = cos(heading);
+		float dirY = sin(heading);
+
+		asteroids.kind[index] = smaller;
+		asteroids.radius[index] = smallerRadius;
+		asteroids.dirX[index] = dirX;
+		asteroids.dirY[index] = dirY;
+		asteroids.velocity[index] = this->astroidVelocity;
+
+		// appended past the range ck_optimize() is sweeping, so it joins next frame
+		TRACE_SCOPE("split");
+		asteroids.add(smaller, asteroids.x[index], asteroids.y[index], -dirX, -dirY, this->astroidVelocity, smallerRadius);
+	}
+	else
+	{
+		// removed once ck_optimize() is done with the broadphase indices
+		asteroids.kill(index);
+		this->score++;
+	}
+}
+
+void World::ast_bounce(int ast1, int ast2)
+{
+	EntityStore &asteroids = this->asteroids;
+
+	float aaaX = asteroids.x[ast1] - asteroids.x[ast2];
+	float aaaY = asteroids.y[ast1] - asteroids.y[ast2];
+	float length = sqrt(pow(aaaX, 2) + pow(aaaY, 2));
+
+	// two asteroids on exactly the same spot (a big wave spawning several per
+	// slot) have no direction to push apart along; dividing by zero here used
+	// to turn both positions into NaN
+	if (length == 0)
+	{
+		return;
+	}
+
+	aaaX /= length;
+	aaaY /= length;
+	asteroids.dirX[ast1] = aaaX;
+	asteroids.dirY[ast1] = aaaY;
+	asteroids.dirX[ast2] = -aaaX;
+	asteroids.dirY[ast2] = -aaaY;
+}
+
+// Counts down the shield flash; the front end tints the ship while shielded.
+void World::make_it_invincible()
+{
+	if (this->ship.flashTimer == 0)
+	{
+		this->ship.flashTimer = 100;
+	}
+	else
+	{
+		this->ship.shielded = true;
+		this->ship.flashTimer--;
+	}
+}
+
+// Groups a flat list of (a, b) pairs by a; with bothWays every pair is also
+// listed under b.
+static void group_pairs(const std::vector<int> &pairs, bool bothWays, int count, std::vector<int> &start, std::vector<int> &list)
+{
+	start.assign(count + 1, 0);
+	for (size_t p = 0; p < pairs.size(); p += 2)
+	{
+		start[pairs[p] + 1]++;
+		if (bothWays)
+		{
+			start[pairs[p + 1] + 1]++;
+		}
+	}
+	for (int i = 0; i < count; i++)
+	{
+		start[i + 1] += start[i];
+	}
+
+	list.resize(start[count]);
+
+	// start[a] doubles as a's write cursor and ends up where a's run ends
+	for (size_t p = 0; p < pairs.size(); p += 2)
+	{
+		list[start[pairs[p]]++] = pairs[p + 1];
+		if (bothWays)
+		{
+			list[start[pairs[p + 1]]++] = pairs[p];
+		}
+	}
+	for (int i = count; i > 0; i--)
+	{
+		start[i] = start[i - 1];
+	}
+	start[0] = 0;
+}
+
+// How far something moved along one axis this tick; a jump of more than half
+// the screen is a wrap, which counts as no move, as in the renderer.
+static float tick_move(float previous, float current, float span)
+{
+	float move = current - previous;
+	return std::fabs(move) > span / 2 ? 0.f : move;
+}
+
+// Fills astPaths and bulletPaths from the positions before and after this
+// tick, path p for bullet bullets.head + p. A circle halfway along a move and
+// grown by half its length holds the entity all tick, so a pair the swept
+// test can hit always has overlapping path circles. Each asteroid only widens
+// its own circle, so one fast asteroid does not drag every bullet into the
+// pairs.
+void World::sweepPaths()
+{
+	const EntityStore &asteroids = this->asteroids;
+	const EntityStore &bullets = this->bullets;
+	AsteroidPaths &astPaths = this->astPaths;
+	BulletPaths &paths = this->bulletPaths;
+
+	astPaths.x.resize(asteroids.size());
+	astPaths.y.resize(asteroids.size());
+	astPaths.radius.resize(asteroids.size());
+	astPaths.largestRadius = 0;
+	for (size_t i = 0; i < asteroids.size(); i++)
+	{
+		float moveX = tick_move(asteroids.prevX[i], asteroids.x[i], GAMEWIDTH);
+		float moveY = tick_move(asteroids.prevY[i], asteroids.y[i], GAMEHEIGHT);
+		astPaths.x[i] = asteroids.x[i] - moveX / 2;
+		astPaths.y[i] = asteroids.y[i] - moveY / 2;
+		astPaths.radius[i] = asteroids.radius[i] + std::sqrt(moveX * moveX + moveY * moveY) / 2;
+		astPaths.largestRadius = std::max(astPaths.largestRadius, astPaths.radius[i]);
+	}
+
+	size_t count = bullets.count();
+	paths.startX.resize(count);
+	paths.startY.resize(count);
+	paths.moveX.resize(count);
+	paths.moveY.resize(count);
+	paths.x.resize(count);
+	paths.y.resize(count);
+	paths.radius.resize(count);
+	paths.largestRadius = 0;
+	for (size_t p = 0; p < count; p++)
+	{
+		size_t j = bullets.head + p;
+		float moveX = tick_move(bullets.prevX[j], bullets.x[j], GAMEWIDTH);
+		float moveY = tick_move(bullets.prevY[j], bullets.y[j], GAMEHEIGHT);
+		paths.moveX[p] = moveX;
+		paths.moveY[p] = moveY;
+		paths.startX[p] = bullets.x[j] - moveX;
+		paths.startY[p] = bullets.y[j] - moveY;
+		paths.x[p] = bullets.x[j] - moveX / 2;
+		paths.y[p] = bullets.y[j] - moveY / 2;
+		paths.radius[p] = bullets.radius[j] + std::sqrt(moveX * moveX + moveY * moveY) / 2;
+		paths.largestRadius = std::max(paths.largestRadius, paths.radius[p]);
+	}
+}
+
+// Rebuilds the selected broadphase, with the bullets entered as their path
+// circles, numbered from bullets.head. The sweep also holds the asteroids as
+// their path circles, which contain them where they are now, so the pairs
+// among asteroids and with the ship still include every overlap.
+void World::buildBroadphase()
+{
+	EntityStore &asteroids = this->asteroids;
+	AsteroidPaths &astPaths = this->astPaths;
+	BulletPaths &paths = this->bulletPaths;
+
+	this->sweepPaths();
+	int astCount = asteroids.size();
+	int bulletCount = this->bullets.count();
+
+	if (this->broadphase == BroadphaseSweep)
+	{
+		this->astSweep.build(astPaths.x.data(), astPaths.y.data(), astPaths.radius.data(), asteroids.id.data(), astCount);
+		this->bulletSweep.build(paths.x.data(), paths.y.data(), paths.radius.data(), this->bullets.id.data() + this->bullets.head, bulletCount);
+
+		std::vector<int> &pairs = this->sweepPairs;
+		pairs.clear();
+		this->astSweep.sweep([&](int a, int b)
+		{
+			pairs.push_back(a);
+			pairs.push_back(b);
+		});
+		group_pairs(pairs, true, astCount, this->astNeighbours.start, this->astNeighbours.list);
+
+		pairs.clear();
+		this->astSweep.sweepAgainst(this->bulletSweep, [&](int a, int j)
+		{
+			pairs.push_back(a);
+			pairs.push_back(j);
+		});
+		group_pairs(pairs, false, astCount, this->bulletNeighbours.start, this->bulletNeighbours.list);
+		return;
+	}
+
+	// an asteroid's path circle is never smaller than the asteroid
+	float largestRadius = std::max(this->shipRadius, std::max(paths.largestRadius, astPaths.largestRadius));
+
+	// two cells per largest radius keeps every overlap inside the 3x3 query
+	// block; bullets are queried from the centre of the asteroid's path. The
+	// path radii change a little every tick, so the size is rounded up to
+	// whole steps and the grids are only reshaped when it crosses one.
+	float cellSize = 2 * std::ceil(largestRadius / CELL_STEP) * CELL_STEP;
+	if (this->astHash.getCellSize() != cellSize)
+	{
+		this->astHash.setCellSize(cellSize);
+		this->bulletHash.setCellSize(cellSize);
+	}
+	this->astHash.build(asteroids.x.data(), asteroids.y.data(), astCount);
+	this->bulletHash.build(paths.x.data(), paths.y.data(), bulletCount);
+}
+
+void World::ck_optimize()
+{
+	PROFILE_SCOPE(ProfileCollide);
+	TRACE_SCOPE("collision");
+
+	EntityStore &asteroids = this->asteroids;
+	EntityStore &bullets = this->bullets;
+
+	int astCount = asteroids.size();
+	PROFILE_COUNT(CounterAsteroids, astCount);
+	PROFILE_COUNT(CounterBullets, bullets.size());
+
+	this->buildBroadphase();
+
+	float shipX = this->ship.x;
+	float shipY = this->ship.y;
+	float shipRadius = this->shipRadius;
+	CandidateBatch &candidates = this->candidates;
+
+	candidates.clear();
+	std::function<void(int)> addShipCandidate = [&](int i)
+	{
+		candidates.add(i, asteroids.x[i], asteroids.y[i], asteroids.radius[i]);
+	};
+	if (this->broadphase == BroadphaseSweep)
+	{
+		this->astSweep.query(shipX, shipY, shipRadius, addShipCandidate);
+	}
+	else
+	{
+		this->astHash.query(shipX, shipY, addShipCandidate);
+	}
+
+	PROFILE_COUNT(CounterCollisionTests, candidates.size());
+	int crashedInto = -1;
+	if (candidates.test(shipX, shipY, shipRadius) > 0)
+	{
+		for (size_t c = 0; c < candidates.size(); c++)
+		{
+			if (candidates.hits[c] && candidates.index[c] > crashedInto)
+			{
+				crashedInto = candidates.index[c];
+			}
+		}
+	}
+
+	// The old sweep went down from the highest index and stopped at the first
+	// asteroid touching the ship, so the asteroids above it still bounced and
+	// took hits on the tick of a crash. Only those are collided before it.
+	int first = crashedInto + 1;
+
+	// Contacts are gathered in parallel from the unchanged store, one chunk of
+	// asteroids per task, then resolved on this thread in the order of the old
+	// descending sweep. The result does not depend on the thread count.
+	int taskCount = (astCount - first + COLLISION_CHUNK - 1) / COLLISION_CHUNK;
+	if ((int)this->contacts.size() < taskCount)
+	{
+		this->contacts.resize(taskCount);
+	}
+
+	std::function<void(int)> gather = [&](int task)
+	{
+		TRACE_SCOPE("gather");
+		int begin = first + task * COLLISION_CHUNK;
+		this->gatherContacts(this->contacts[task], begin, std::min(begin + COLLISION_CHUNK, astCount));
+	};
+
+	int threads = this->collisionThreads > 0 ? this->collisionThreads : this->hardwareThreads;
+	if (taskCount == 1)
+	{
+		// one chunk: no pool, and no call through gather
+		TRACE_SCOPE("gather");
+		this->gatherContacts(this->contacts[0], first, astCount);
+	}
+	else if (threads > 1 && taskCount > 1)
+	{
+		if (!this->pool || this->pool->getThreadCount() != threads)
+		{
+			this->pool = std::make_shared<WorkerPool>(threads);
+		}
+		this->pool->run(taskCount, gather);
+	}
+	else
+	{
+		for (int task = 0; task < taskCount; task++)
+		{
+			gather(task);
+		}
+	}
+
+	for (int task = taskCount - 1; task >= 0; task--)
+	{
+		int begin = first + task * COLLISION_CHUNK;
+		PROFILE_COUNT(CounterCollisionTests, this->contacts[task].tests);
+		this->resolveContacts(this->contacts[task], begin, std::min(begin + COLLISION_CHUNK, astCount));
+	}
+
+	if (crashedInto >= 0)
+	{
+		this->dispatchContact(KindShip, 0, asteroids.kind[crashedInto], crashedInto);
+	}
+
+	bullets.compact();
+	asteroids.compact();
+}
+
+// Records every asteroid touching asteroids [begin, end), and every bullet
+// that touched one of them at some point this tick, highest index first.
+// Only reads the stores, so chunks can be gathered in parallel.
+// The asteroids an asteroid touches are listed in ascending index order,
+// whichever broadphase found them, so both give the same bounces.
+void World::gatherContacts(ContactBuffer &buffer, int begin, int end) const
+{
+	const EntityStore &asteroids = this->asteroids;
+	const EntityStore &bullets = this->bullets;
+	const BulletPaths &paths = this->bulletPaths;
+	CandidateBatch &candidates = buffer.candidates;
+	bool sweep = this->broadphase == BroadphaseSweep;
+
+	buffer.bounces.clear();
+	buffer.hits.clear();
+	buffer.hitTimes.clear();
+	buffer.tests = 0;
+
+	for (int i = end - 1; i >= begin; i--)
+	{
+		float astX = asteroids.x[i];
+		float astY = asteroids.y[i];
+		float astRadius = asteroids.radius[i];
+
+		candidates.clear();
+		if (sweep)
+		{
+			for (int n = this->astNeighbours.start[i]; n < this->astNeighbours.start[i + 1]; n++)
+			{
+				int k = this->astNeighbours.list[n];
+				candidates.add(k, asteroids.x[k], asteroids.y[k], asteroids.radius[k]);
+			}
+		}
+		else
+		{
+			this->astHash.query(astX, astY, [&](int k)
+			{
+				if (k != i)
+				{
+					candidates.add(k, asteroids.x[k], asteroids.y[k], asteroids.radius[k]);
+				}
+			});
+		}
+
+		buffer.tests += candidates.size();
+		if (candidates.test(astX, astY, astRadius) > 0)
+		{
+			buffer.found.clear();
+			for (size_t c = 0; c < candidates.size(); c++)
+			{
+				if (candidates.hits[c])
+				{
+					buffer.found.push_back(candidates.index[c]);
+				}
+			}
+
+			std::sort(buffer.found.begin(), buffer.found.end());
+			for (size_t f = 0; f < buffer.found.size(); f++)
+			{
+				buffer.bounces.push_back(i);
+				buffer.bounces.push_back(buffer.found[f]);
+			}
+		}
+
+		// bullets are swept along their paths, against the asteroid's own move
+		candidates.clear();
+		if (sweep)
+		{
+			for (int n = this->bulletNeighbours.start[i]; n < this->bulletNeighbours.start[i + 1]; n++)
+			{
+				int p = this->bulletNeighbours.list[n];
+				candidates.addMoving(bullets.head + p, paths.startX[p], paths.startY[p], paths.moveX[p], paths.moveY[p], bullets.radius[bullets.head + p]);
+			}
+		}
+		else
+		{
+			// the grid block is far wider than the path circles, so only the
+			// bullets whose path circle meets the asteroid's, with the same
+			// slack the sweep pads its bounds by, go on to the swept test
+			float pathX = this->astPaths.x[i];
+			float pathY = this->astPaths.y[i];
+			float pathRadius = this->astPaths.radius[i] + SWEEP_PADDING;
+			this->bulletHash.query(pathX, pathY, [&](int p)
+			{
+				if (is_collided(pathX, pathY, pathRadius, paths.x[p], paths.y[p], paths.radius[p]))
+				{
+					candidates.addMoving(bullets.head + p, paths.startX[p], paths.startY[p], paths.moveX[p], paths.moveY[p], bullets.radius[bullets.head + p]);
+				}
+			});
+		}
+
+		float astMoveX = tick_move(asteroids.prevX[i], astX, GAMEWIDTH);
+		float astMoveY = tick_move(asteroids.prevY[i], astY, GAMEHEIGHT);
+		buffer.tests += candidates.size();
+		if (candidates.testSwept(astX - astMoveX, astY - astMoveY, astMoveX, astMoveY, astRadius) > 0)
+		{
+			for (size_t c = 0; c < candidates.size(); c++)
+			{
+				if (candidates.hits[c])
+				{
+					buffer.hits.push_back(i);
+					buffer.hits.push_back(candidates.index[c]);
+					buffer.hitTimes.push_back(candidates.times[c]);
+				}
+			}
+		}
+	}
+}
+
+// Applies one chunk's contacts. Earlier chunks may have killed bullets or
+// shrunk and killed asteroids since the contacts were gathered, so every pair
+// is checked again against the current state, exactly as the sweep would
+// have seen it.
+void World::resolveContacts(const ContactBuffer &buffer, int begin, int end)
+{
+	EntityStore &asteroids = this->asteroids;
+	EntityStore &bullets = this->bullets;
+
+	size_t b = 0, h = 0;
+	for (int i = end - 1; i >= begin; i--)
+	{
+		for (; b < buffer.bounces.size() && buffer.bounces[b] == i; b += 2)
+		{
+			int k = buffer.bounces[b + 1];
+			this->dispatchContact(asteroids.kind[i], i, asteroids.kind[k], k);
+		}
+
+		// the bullet that got there first takes the hit; of bullets arriving
+		// together, the highest-index one, like the old descending scan
+		int hitBy = -1;
+		float hitTime = 0;
+		for (; h < buffer.hits.size() && buffer.hits[h] == i; h += 2)
+		{
+			int j = buffer.hits[h + 1];
+			float time = buffer.hitTimes[h / 2];
+			if (bullets.alive[j] && (hitBy < 0 || time < hitTime || (time == hitTime && j > hitBy)))
+			{
+				hitBy = j;
+				hitTime = time;
+			}
+		}
+
+		if (hitBy >= 0)
+		{
+			this->dispatchContact(asteroids.kind[i], i, bullets.kind[hitBy], hitBy);
+		}
+	}
+}
+
+// Runs the response for a contact between entity first of kind firstKind and
+// entity second of kind secondKind, if the pair has one.
+void World::dispatchContact(int firstKind, int first, int secondKind, int second)
+{
+	ContactHandler handler = contactTable[firstKind * KindCount + secondKind];
+	if (handler)
+	{
+		(this->*handler)(first, second);
+	}
+}
+
+// Asteroid against asteroid. The other one may have been killed or shrunk by
+// an earlier contact this frame, so the pair is tested again.
+void World::bounceContact(int ast1, int ast2)
+{
+	EntityStore &asteroids = this->asteroids;
+
+	if (asteroids.alive[ast2] && is_collided(asteroids.x[ast1], asteroids.y[ast1], asteroids.radius[ast1], asteroids.x[ast2], asteroids.y[ast2], asteroids.radius[ast2]))
+	{
+		this->ast_bounce(ast1, ast2);
+	}
+}
+
+void World::bulletContact(int asteroid, int bullet)
+{
+	this->bullets.kill(bullet);
+	this->ast_get_hit(asteroid);
+}
+
+void World::crashContact(int, int)
+{
+	this->emit(EventCrash, this->ship.x, this->ship.y);
+
+	this->life--;
+	this->respawn();
+}
+
+// Same test as circle_hits(), for a single pair.
+bool World::is_collided(float x1, float y1, float r1, float x2, float y2, float r2)
+{
+	float dx = x2 - x1;
+	float dy = y2 - y1;
+	float reach = r1 + r2;
+
+	return dx * dx + dy * dy <= reach * reach;
+}
+
+// Takes over source's state but keeps this world's worker pool and contact
+// buffers, so a benchmark can reset a world between timed calls without
+// paying for new threads and first-use allocations in every call.
+void World::restoreFrom(const World &source)
+{
+	std::shared_ptr<WorkerPool> pool = this->pool;
+	std::vector<ContactBuffer> contacts;
+	contacts.swap(this->contacts);
+
+	*this = source;
+
+	this->pool = pool;
+	this->contacts.swap(contacts);
+}
+
+void World::restart()
+{
+	this->astroidVelocity = 250;
+	this->level = 1;
+	this->score = 0;
+	this->life = 3;
+	this->bullets.clear();
+	this->asteroids.clear();
+	this->create_ast();
+	this->centreShip();
+}
+
+void World::respawn()
+{
+	TRACE_INSTANT("respawn");
+	this->bullets.clear();
+	this->centreShip();
+}
+
+void World::levelUp()
+{
+	TRACE_INSTANT("level up");
+	this->emit(EventLevelUp, this->ship.x, this->ship.y);
+	this->level++;
+	this->bullets.clear();
+	this->asteroids.clear();
+	this->astroidVelocity += 50;
+	this->create_ast();
+	this->centreShip();
+}
+
+World::~World()
+{
+}
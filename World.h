@@ -0,0 +1,221 @@
+#pragma once
+#include <array>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "EntityStore.h"
+#include "Input.h"
+#include "NarrowPhase.h"
+#include "Profiler.h"
+#include "Random.h"
+#include "SpatialHash.h"
+#include "SweepAndPrune.h"
+#include "WorkerPool.h"
+
+const int GAMEWIDTH = 2880;
+const int GAMEHEIGHT = 1800;
+
+const float PI = 3.1415926;
+
+// most asteroids a wave may start with; ten times the largest bench case
+const int MAX_ASTEROIDS_PER_WAVE = 1000000;
+
+bool valid_wave_size(int);
+
+// Simulation-side ship state. The SpaceShip shape in the front end is only used
+// to draw it.
+struct Ship
+{
+	float x;
+	float y;
+	float prevX;
+	float prevY;
+	float rotation;
+	// the ship keeps drifting along the last direction it was steered in,
+	// (0, 0) until the first key press
+	float driftVelocity;
+	float driftX;
+	float driftY;
+	int flashTimer;
+	bool shielded;
+};
+
+// Things that happened during a step which the front end may want to play a
+// sound or an animation for.
+enum WorldEventType
+{
+	EventShoot,
+	EventDrift,
+	EventDriftStop,
+	EventExplode,
+	EventCrash,
+	EventLevelUp
+};
+
+// Which broadphase ck_optimize() finds its candidate pairs with. Both give the
+// same results; they only differ in speed.
+enum BroadphaseKind
+{
+	BroadphaseGrid,
+	BroadphaseSweep
+};
+
+struct WorldEvent
+{
+	int type;
+	float x;
+	float y;
+};
+
+// The whole game simulation: ship, asteroids, bullets, collisions and level
+// flow. It has no window, no audio and no SFML dependency; it is advanced with
+// an Input and a fixed tick length and reports what happened through events.
+class World
+{
+private:
+	// broadphase for ck_optimize(), rebuilt every frame straight from the store columns
+	SpatialHash astHash;
+	SpatialHash bulletHash;
+
+	// the sweep-and-prune alternative; its pairs are grouped per asteroid,
+	// the neighbours of i being list[start[i] .. start[i + 1])
+	struct Neighbours
+	{
+		std::vector<int> start;
+		std::vector<int> list;
+	};
+	SweepAndPrune astSweep;
+	SweepAndPrune bulletSweep;
+	std::vector<int> sweepPairs;
+	Neighbours astNeighbours;
+	Neighbours bulletNeighbours;
+	// packed broadphase candidates for the batched narrow phase
+	CandidateBatch candidates;
+
+	// Bullets are tested along their whole path through the tick, so fast
+	// ones cannot pass through an asteroid between two ticks. Rebuilt by
+	// sweepPaths(): where each bullet started the tick, how far it moved
+	// (nothing, if it wrapped), and a circle around its path that the
+	// broadphases store in its place.
+	struct BulletPaths
+	{
+		std::vector<float> startX;
+		std::vector<float> startY;
+		std::vector<float> moveX;
+		std::vector<float> moveY;
+		std::vector<float> x;
+		std::vector<float> y;
+		std::vector<float> radius;
+		float largestRadius;
+	};
+	BulletPaths bulletPaths;
+
+	// The same circle around each asteroid's move through the tick, which the
+	// broadphases pair with the bullet paths.
+	struct AsteroidPaths
+	{
+		std::vector<float> x;
+		std::vector<float> y;
+		std::vector<float> radius;
+		float largestRadius;
+	};
+	AsteroidPaths astPaths;
+
+	// Contacts found for one chunk of asteroids, as flattened (asteroid, other)
+	// index pairs in the order the single-threaded sweep would meet them.
+	struct ContactBuffer
+	{
+		CandidateBatch candidates;
+		std::vector<int> found;
+		std::vector<int> bounces;
+		std::vector<int> hits;
+		// contact time of each hits pair, as a fraction of the tick
+		std::vector<float> hitTimes;
+		// narrow-phase circle tests made, for the profiler
+		long long tests;
+	};
+	std::vector<ContactBuffer> contacts;
+	// shared by copies of the world; only one of them collides at a time
+	std::shared_ptr<WorkerPool> pool;
+	// what collisionThreads 0 stands for, asked for once at construction
+	int hardwareThreads;
+
+	// the simulation's random streams, and scratch for drawing a wave at once
+	Random spawnRandom;
+	Random splitRandom;
+	std::vector<uint32_t> spawnSizes;
+	std::vector<float> spawnAlong;
+	std::vector<float> spawnHeading;
+
+	void sweepPaths();
+	void gatherContacts(ContactBuffer &, int, int) const;
+	void resolveContacts(const ContactBuffer &, int, int);
+
+	// Collision response, looked up by the kinds of the two things touching.
+	// The table is filled at compile time from contactRule(); handlers get the
+	// two indices directly (0 for the ship) and an empty entry means the pair
+	// is ignored.
+	typedef void (World::*ContactHandler)(int, int);
+	typedef std::array<ContactHandler, KindCount * KindCount> ContactTable;
+	static const ContactTable contactTable;
+	static constexpr ContactHandler contactRule(int, int);
+	template <size_t... Pair>
+	static constexpr ContactTable makeContactTable(std::index_sequence<Pair...>);
+	void dispatchContact(int, int, int, int);
+	void bounceContact(int, int);
+	void bulletContact(int, int);
+	void crashContact(int, int);
+	void moveShip(float, float);
+	void centreShip();
+	void emit(int, float, float);
+
+public:
+	float bulletVelocity;
+	float shipRadius;
+	float bulletRadius;
+	float bulletLifetime;
+	float shipVelocity;
+	float speedInterval;
+	float astroidVelocity;
+	float sAstRadius;
+	float mAstRadius;
+	float bAstRadius;
+	int asteroidsPerWave;
+	// threads for the collision pass; 0 uses one per hardware thread
+	int collisionThreads;
+	// a BroadphaseKind
+	int broadphase;
+
+	Ship ship;
+	EntityStore asteroids;
+	EntityStore bullets;
+	// ticks stepped since the world was created; bullet lifetimes count these
+	unsigned tick;
+	int score, life, level;
+
+	// filled by step(), cleared at the start of the next one
+	std::vector<WorldEvent> events;
+
+	World();
+	void seed(unsigned);
+	void step(const Input &, float);
+	void setControl(const Input &, float);
+	void update_state(const Input &, float);
+	unsigned bulletLifetimeTicks(float) const;
+	void move_bullets(float);
+	void move_asteroids(float);
+	void shoot();
+	void create_ast();
+	void ast_get_hit(int);
+	void ast_bounce(int, int);
+	void make_it_invincible();
+	void buildBroadphase();
+	void ck_optimize();
+	static bool is_collided(float, float, float, float, float, float);
+	void restart();
+	void restoreFrom(const World &);
+	void respawn();
+	void levelUp();
+	~World();
+};